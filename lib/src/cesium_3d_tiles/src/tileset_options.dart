@@ -12,6 +12,26 @@ class TilesetOptions {
     final int maximumSimultaneousSubtreeLoads;
     final int loadingDescendantLimit;
 
+    /// Cancel downloads of tiles that stay culled or unvisited while loading.
+    final bool cancelStaleTileLoads;
+
+    /// Retries for network errors and 408/429/5xx responses, with jittered
+    /// exponential backoff starting at [retryBaseDelayMs].
+    final int maxRetries;
+    final int retryBaseDelayMs;
+
+    /// Send a duplicate request once a request is slower than this percentile
+    /// (0-100) of recent request latencies. 0 disables hedging.
+    final double hedgePercentile;
+
+    /// Keep tile models in the tile cache in their decoded form (Draco and
+    /// meshopt compression removed), so loading them again skips decoding.
+    /// Requires a cache path to be set when initializing. Decoded models are
+    /// stored next to the raw tiles and count against the same
+    /// `cacheMaxItems` and `cacheMaxBytes` budget, so a cached tile may take
+    /// up two entries.
+    final bool cacheDecodedModels;
+
   const TilesetOptions({
     this.forbidHoles = false,
     this.enableLodTransitionPeriod = false,
@@ -25,5 +45,10 @@ class TilesetOptions {
     this.maximumSimultaneousTileLoads = 20,
     this.maximumSimultaneousSubtreeLoads = 20,
     this.loadingDescendantLimit = 20,
+    this.cancelStaleTileLoads = true,
+    this.maxRetries = 3,
+    this.retryBaseDelayMs = 200,
+    this.hedgePercentile = 0,
+    this.cacheDecodedModels = false,
   });
 }
\ No newline at end of file
@@ -4,3 +4,5 @@ export 'src/cartographic_position.dart';
 export 'src/cesium_native.dart';
 export 'src/cesium_view.dart';
 export 'src/cesium_bounding_volume.dart';
+export 'src/cesium_network_stats.dart';
+export 'src/cesium_region_seed.dart';
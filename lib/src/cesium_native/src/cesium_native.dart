@@ -15,6 +15,8 @@ import 'package:vector_math/vector_math_64.dart';
 
 import 'cesium_tile_selection_state.dart';
 import 'cesium_native_options.dart';
+import 'cesium_network_stats.dart';
+import 'cesium_region_seed.dart';
 
 class CesiumTileset {
   final Pointer<g.CesiumTileset> _ptr;
@@ -22,6 +24,42 @@ class CesiumTileset {
   CesiumTileset(this._ptr);
 }
 
+///
+/// A running [CesiumNative.seedRegion] operation.
+///
+class CesiumRegionSeed {
+  final Pointer<g.CesiumSeed> _ptr;
+  final NativeCallable<Void Function(g.CesiumSeedProgress)> _callback;
+  final StreamController<CesiumSeedProgress> _progress;
+
+  CesiumRegionSeed._(this._ptr, this._callback, this._progress);
+
+  ///
+  /// Emits after each completed viewpoint; the last event has a state other
+  /// than [CesiumSeedState.Running], after which the stream closes.
+  ///
+  Stream<CesiumSeedProgress> get progress => _progress.stream;
+
+  ///
+  /// Stops seeding after the viewpoint currently being loaded.
+  ///
+  void cancel() {
+    g.CesiumTileset_cancelSeed(_ptr);
+  }
+
+  ///
+  /// Cancels seeding if it is still running and releases its resources
+  /// without waiting for the viewpoint being loaded to finish.
+  ///
+  void dispose() {
+    g.CesiumTileset_destroySeed(_ptr);
+    _callback.close();
+    if (!_progress.isClosed) {
+      _progress.close();
+    }
+  }
+}
+
 typedef CesiumTile = Pointer<g.CesiumTile>;
 typedef CesiumGltfModel = Pointer<g.CesiumGltfModel>;
 
@@ -82,14 +120,258 @@ class CesiumNative {
             ? opts.cacheDbPath!.toNativeUtf8().cast<Char>()
             : nullptr;
 
+    final networkOptions = Struct.create<g.CesiumNetworkOptions>();
+    networkOptions.shareConnectionCache = opts.shareConnectionCache;
+    networkOptions.maxIdleHandles = opts.maxIdleHandles;
+    networkOptions.httpVersion = opts.httpVersion.index;
+    networkOptions.maxConcurrentStreams = opts.maxConcurrentStreams;
+    networkOptions.maxConnectionsPerHost = opts.maxConnectionsPerHost;
+    networkOptions.mode = opts.networkMode.index;
+    networkOptions.recordingPath = opts.recordingPath != null
+        ? opts.recordingPath!.toNativeUtf8().cast<Char>()
+        : nullptr;
+    networkOptions.simulateRecordedLatency = opts.simulateRecordedLatency;
+    networkOptions.memoryCacheBytes = opts.memoryCacheBytes;
+    networkOptions.cacheMaxItems = opts.cacheMaxItems;
+    networkOptions.cacheMaxBytes = opts.cacheMaxBytes;
+    networkOptions.cachePolicy = opts.cachePolicy.index;
+    networkOptions.cachePruneInterval = opts.cachePruneInterval;
+    networkOptions.negativeCacheTtlSeconds = opts.negativeCacheTtl.inSeconds;
+    networkOptions.negativeCacheMaxEntries = opts.negativeCacheMaxEntries;
+    networkOptions.httpBackend = opts.httpBackend.index;
+
     try {
-      g.CesiumTileset_initialize(opts.numThreads, cachePathPtr);
+      g.CesiumTileset_initialize(
+          opts.numThreads, opts.numIoThreads, cachePathPtr, networkOptions);
       _initialized = true;
       _errorMessage = calloc<Char>(256);
     } finally {
       if (cachePathPtr != nullptr) {
         calloc.free(cachePathPtr.cast<Utf8>());
       }
+      if (networkOptions.recordingPath != nullptr) {
+        calloc.free(networkOptions.recordingPath.cast<Utf8>());
+      }
+    }
+  }
+
+  ///
+  /// Returns the connection reuse counters for all tile requests.
+  ///
+  CesiumConnectionStats getConnectionStats() {
+    final stats = g.CesiumTileset_getConnectionStats();
+    return CesiumConnectionStats(
+        stats.requests,
+        stats.newConnections,
+        stats.reusedConnections,
+        stats.reusedHandles,
+        stats.cancelledRequests,
+        stats.bytesSavedByCancellation,
+        stats.revalidations,
+        stats.notModifiedResponses,
+        stats.bytesSavedByRevalidation);
+  }
+
+  ///
+  /// Returns per-request timing histograms for all network requests. Pass
+  /// [reset] to start a new measurement window after reading.
+  ///
+  CesiumNetworkStats getNetworkStats({bool reset = false}) {
+    final stats = g.CesiumTileset_getNetworkStats(reset);
+    return CesiumNetworkStats(
+        _toHistogram(stats.dnsTime),
+        _toHistogram(stats.connectTime),
+        _toHistogram(stats.tlsTime),
+        _toHistogram(stats.timeToFirstByte),
+        _toHistogram(stats.totalTime),
+        _toHistogram(stats.responseBytes),
+        stats.http1Requests,
+        stats.http2Requests,
+        stats.http3Requests,
+        _toHistogram(stats.decodeTime),
+        stats.gzipResponses,
+        stats.brotliResponses,
+        stats.zstdResponses,
+        stats.compressedBytes,
+        stats.decodedBytes);
+  }
+
+  ///
+  /// Writes tile cache entries that are still queued to disk. Call this
+  /// before the app may be suspended or killed; [destroy] also does this.
+  ///
+  void flushCache() {
+    g.CesiumTileset_flushCache();
+  }
+
+  ///
+  /// Returns the tile cache counters. If [reset] is true, hit, miss and
+  /// prune counters and the histograms start a new measurement window.
+  ///
+  CesiumCacheStats getCacheStats({bool reset = false}) {
+    final stats = g.CesiumTileset_getCacheStats(reset);
+    return CesiumCacheStats(
+        stats.memoryHits,
+        stats.memoryMisses,
+        stats.memoryEvictions,
+        stats.memoryEntries,
+        stats.memoryBytes,
+        stats.hits,
+        stats.misses,
+        stats.entries,
+        stats.bytes,
+        stats.pendingEntries,
+        stats.prunes,
+        stats.prunedEntries,
+        _toHistogram(stats.lookupTime),
+        _toHistogram(stats.pruneTime),
+        _toHistogram(stats.commitTime),
+        stats.decodedModelHits,
+        stats.decodedModelStores,
+        stats.negativeHits,
+        stats.negativeEntries);
+  }
+
+  ///
+  /// Changes the tile cache budget and prunes down to it in the background.
+  /// [memoryBytes] resizes the in-memory tier, which cannot be enabled here if
+  /// [CesiumNativeOptions.memoryCacheBytes] was 0. A value of 0 for
+  /// [maxItems] or [maxBytes] means unlimited.
+  ///
+  void setCacheLimits(
+      {required int maxItems, required int maxBytes, required int memoryBytes}) {
+    g.CesiumTileset_setCacheLimits(maxItems, maxBytes, memoryBytes);
+  }
+
+  ///
+  /// Changes which entries later prunes remove first.
+  ///
+  void setCachePolicy(CesiumCachePolicy policy) {
+    g.CesiumTileset_setCachePolicy(policy.index);
+  }
+
+  ///
+  /// Removes expired entries and prunes the tile cache down to its budget in
+  /// the background.
+  ///
+  void pruneCache() {
+    g.CesiumTileset_pruneCache();
+  }
+
+  ///
+  /// Removes every entry from the tile cache in the background and forgets
+  /// remembered 404 and 410 responses.
+  ///
+  void clearCache() {
+    g.CesiumTileset_clearCache();
+  }
+
+  CesiumNetworkHistogram _toHistogram(g.CesiumNetworkHistogram histogram) {
+    return CesiumNetworkHistogram(
+        histogram.count,
+        histogram.sum,
+        histogram.max,
+        List<int>.generate(
+            g.CESIUM_NETWORK_HISTOGRAM_BUCKETS, (i) => histogram.buckets[i]));
+  }
+
+  ///
+  /// Starts loading every tile needed to view [region] of the tileset at
+  /// [url] (or of the Cesium ion asset [assetId]) into the tile cache.
+  /// Requires a cache path in [initialize]. The seeded tiles are pinned:
+  /// pruning keeps them regardless of expiry and cache limits, and expired
+  /// ones are still served when the network fails. Only [clearCache] removes
+  /// them. Call [CesiumRegionSeed.dispose] when done.
+  ///
+  CesiumRegionSeed seedRegion(CesiumSeedRegion region,
+      {String? url, int? assetId, String? accessToken}) {
+    if ((url == null) == (assetId == null)) {
+      throw ArgumentError("Exactly one of url and assetId must be provided");
+    }
+    if (region.north < region.south) {
+      throw ArgumentError("north must not be below south");
+    }
+    if (region.minHeight > region.maxHeight) {
+      throw ArgumentError("minHeight must not be above maxHeight");
+    }
+    final progress = StreamController<CesiumSeedProgress>.broadcast();
+    final callback =
+        NativeCallable<Void Function(g.CesiumSeedProgress)>.listener(
+            (g.CesiumSeedProgress p) {
+      if (progress.isClosed) {
+        return;
+      }
+      final state = CesiumSeedState.values[p.state];
+      progress.add(CesiumSeedProgress(state, p.completedViewpoints,
+          p.totalViewpoints, p.requests, p.bytes));
+      if (state != CesiumSeedState.Running) {
+        progress.close();
+      }
+    });
+
+    final optionsStruct = Struct.create<g.CesiumSeedOptions>();
+    optionsStruct.west = region.west;
+    optionsStruct.south = region.south;
+    optionsStruct.east = region.east;
+    optionsStruct.north = region.north;
+    optionsStruct.minHeight = region.minHeight;
+    optionsStruct.maxHeight = region.maxHeight;
+    optionsStruct.maximumScreenSpaceError = region.maximumScreenSpaceError;
+    optionsStruct.viewpointsPerAxis = region.viewpointsPerAxis;
+    optionsStruct.maxConcurrentRequests = region.maxConcurrentRequests;
+
+    final statePathPtr = region.statePath == null
+        ? nullptr
+        : region.statePath!.toNativeUtf8(allocator: calloc).cast<Char>();
+    final sourcePtr =
+        (url ?? accessToken ?? "").toNativeUtf8(allocator: calloc).cast<Char>();
+    optionsStruct.statePath = statePathPtr;
+    try {
+      final seedPtr = url != null
+          ? g.CesiumTileset_seedRegion(
+              sourcePtr, optionsStruct, callback.nativeFunction)
+          : g.CesiumTileset_seedRegionFromIonAsset(
+              assetId!, sourcePtr, optionsStruct, callback.nativeFunction);
+      if (seedPtr == nullptr) {
+        callback.close();
+        progress.close();
+        throw Exception("Failed to start seeding; is the tile cache enabled?");
+      }
+      return CesiumRegionSeed._(seedPtr, callback, progress);
+    } finally {
+      calloc.free(sourcePtr);
+      if (statePathPtr != nullptr) {
+        calloc.free(statePathPtr);
+      }
+    }
+  }
+
+  ///
+  /// Limits the combined download rate of all tile requests (cache hits are
+  /// not throttled). A value of 0 means unlimited.
+  ///
+  void setGlobalRateLimit(
+      {double bytesPerSecond = 0, double requestsPerSecond = 0}) {
+    g.CesiumTileset_setGlobalRateLimit(bytesPerSecond, requestsPerSecond);
+  }
+
+  ///
+  /// Limits the download rate of tile requests to [host]. If [host] is null,
+  /// the limits apply to every host without host-specific limits.
+  /// A value of 0 means unlimited.
+  ///
+  void setHostRateLimit(String? host,
+      {double bytesPerSecond = 0, double requestsPerSecond = 0}) {
+    final hostPtr = host == null
+        ? nullptr
+        : host.toNativeUtf8(allocator: calloc).cast<Char>();
+    try {
+      g.CesiumTileset_setHostRateLimit(
+          hostPtr, bytesPerSecond, requestsPerSecond);
+    } finally {
+      if (hostPtr != nullptr) {
+        calloc.free(hostPtr);
+      }
     }
   }
 
@@ -122,6 +404,11 @@ class CesiumNative {
     optionsStruct.maximumSimultaneousSubtreeLoads =
         options.maximumSimultaneousSubtreeLoads;
     optionsStruct.loadingDescendantLimit = options.loadingDescendantLimit;
+    optionsStruct.cancelStaleTileLoads = options.cancelStaleTileLoads;
+    optionsStruct.maxRetries = options.maxRetries;
+    optionsStruct.retryBaseDelayMs = options.retryBaseDelayMs;
+    optionsStruct.hedgePercentile = options.hedgePercentile;
+    optionsStruct.cacheDecodedModels = options.cacheDecodedModels;
 
     final tilesetPtr = g.CesiumTileset_createFromIonAsset(assetId,
         ptr.cast<Char>(), optionsStruct, rootTileAvailable.nativeFunction);
@@ -179,6 +466,11 @@ class CesiumNative {
     optionsStruct.maximumSimultaneousSubtreeLoads =
         options.maximumSimultaneousSubtreeLoads;
     optionsStruct.loadingDescendantLimit = options.loadingDescendantLimit;
+    optionsStruct.cancelStaleTileLoads = options.cancelStaleTileLoads;
+    optionsStruct.maxRetries = options.maxRetries;
+    optionsStruct.retryBaseDelayMs = options.retryBaseDelayMs;
+    optionsStruct.hedgePercentile = options.hedgePercentile;
+    optionsStruct.cacheDecodedModels = options.cacheDecodedModels;
 
     final tilesetPtr = g.CesiumTileset_create(
         ptr.cast<Char>(), optionsStruct, rootTileAvailable.nativeFunction);
@@ -309,6 +601,15 @@ class CesiumNative {
     return g.CesiumTileset_getNumTilesLoaded(tileset._ptr);
   }
 
+  ///
+  /// Returns the retry and hedged request counters for [tileset].
+  ///
+  CesiumTilesetRequestStats getRequestStats(CesiumTileset tileset) {
+    final stats = g.CesiumTileset_getRequestStats(tileset._ptr);
+    return CesiumTilesetRequestStats(stats.requests, stats.retries,
+        stats.hedges, stats.hedgeWins, stats.failures);
+  }
+
   ///
   /// Fetches the root CesiumTile for the tileset.
   /// If the tileset is not yet loaded, the return value will be null.
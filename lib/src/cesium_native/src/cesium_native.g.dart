@@ -7,10 +7,58 @@ library;
 
 import 'dart:ffi' as ffi;
 
-@ffi.Native<ffi.Void Function(ffi.Uint32, ffi.Pointer<ffi.Char>)>()
+@ffi.Native<
+    ffi.Void Function(
+        ffi.Uint32, ffi.Uint32, ffi.Pointer<ffi.Char>, CesiumNetworkOptions)>()
 external void CesiumTileset_initialize(
   int numThreads,
+  int numIoThreads,
   ffi.Pointer<ffi.Char> cacheDbPath,
+  CesiumNetworkOptions networkOptions,
+);
+
+@ffi.Native<CesiumConnectionStats Function()>()
+external CesiumConnectionStats CesiumTileset_getConnectionStats();
+
+@ffi.Native<CesiumNetworkStats Function(ffi.Bool)>()
+external CesiumNetworkStats CesiumTileset_getNetworkStats(
+  bool reset,
+);
+
+@ffi.Native<CesiumCacheStats Function(ffi.Bool)>()
+external CesiumCacheStats CesiumTileset_getCacheStats(
+  bool reset,
+);
+
+@ffi.Native<ffi.Void Function(ffi.Uint64, ffi.Uint64, ffi.Uint64)>()
+external void CesiumTileset_setCacheLimits(
+  int maxItems,
+  int maxBytes,
+  int memoryBytes,
+);
+
+@ffi.Native<ffi.Void Function(ffi.Int32)>()
+external void CesiumTileset_setCachePolicy(
+  int policy,
+);
+
+@ffi.Native<ffi.Void Function()>()
+external void CesiumTileset_pruneCache();
+
+@ffi.Native<ffi.Void Function()>()
+external void CesiumTileset_clearCache();
+
+@ffi.Native<ffi.Void Function(ffi.Double, ffi.Double)>()
+external void CesiumTileset_setGlobalRateLimit(
+  double bytesPerSecond,
+  double requestsPerSecond,
+);
+
+@ffi.Native<ffi.Void Function(ffi.Pointer<ffi.Char>, ffi.Double, ffi.Double)>()
+external void CesiumTileset_setHostRateLimit(
+  ffi.Pointer<ffi.Char> host,
+  double bytesPerSecond,
+  double requestsPerSecond,
 );
 
 @ffi.Native<ffi.Void Function()>()
@@ -67,6 +115,11 @@ external void CesiumTileset_getErrorMessage(
   ffi.Pointer<ffi.Char> out,
 );
 
+@ffi.Native<CesiumTilesetRequestStats Function(ffi.Pointer<CesiumTileset>)>()
+external CesiumTilesetRequestStats CesiumTileset_getRequestStats(
+  ffi.Pointer<CesiumTileset> tileset,
+);
+
 @ffi.Native<
     ffi.Void Function(ffi.Pointer<CesiumTileset>,
         ffi.Pointer<ffi.NativeFunction<ffi.Void Function()>>)>()
@@ -75,6 +128,47 @@ external void CesiumTileset_destroy(
   ffi.Pointer<ffi.NativeFunction<ffi.Void Function()>> onTileDestroyEvent,
 );
 
+@ffi.Native<ffi.Void Function()>()
+external void CesiumTileset_flushCache();
+
+@ffi.Native<
+    ffi.Pointer<CesiumSeed> Function(
+        ffi.Pointer<ffi.Char>,
+        CesiumSeedOptions,
+        ffi.Pointer<
+            ffi.NativeFunction<ffi.Void Function(CesiumSeedProgress)>>)>()
+external ffi.Pointer<CesiumSeed> CesiumTileset_seedRegion(
+  ffi.Pointer<ffi.Char> url,
+  CesiumSeedOptions options,
+  ffi.Pointer<ffi.NativeFunction<ffi.Void Function(CesiumSeedProgress)>>
+      callback,
+);
+
+@ffi.Native<
+    ffi.Pointer<CesiumSeed> Function(
+        ffi.Int64,
+        ffi.Pointer<ffi.Char>,
+        CesiumSeedOptions,
+        ffi.Pointer<
+            ffi.NativeFunction<ffi.Void Function(CesiumSeedProgress)>>)>()
+external ffi.Pointer<CesiumSeed> CesiumTileset_seedRegionFromIonAsset(
+  int assetId,
+  ffi.Pointer<ffi.Char> accessToken,
+  CesiumSeedOptions options,
+  ffi.Pointer<ffi.NativeFunction<ffi.Void Function(CesiumSeedProgress)>>
+      callback,
+);
+
+@ffi.Native<ffi.Void Function(ffi.Pointer<CesiumSeed>)>()
+external void CesiumTileset_cancelSeed(
+  ffi.Pointer<CesiumSeed> seed,
+);
+
+@ffi.Native<ffi.Void Function(ffi.Pointer<CesiumSeed>)>()
+external void CesiumTileset_destroySeed(
+  ffi.Pointer<CesiumSeed> seed,
+);
+
 @ffi.Native<
     ffi.Int Function(ffi.Pointer<CesiumTileset>, CesiumViewState, ffi.Float)>()
 external int CesiumTileset_updateView(
@@ -288,6 +382,21 @@ final class CesiumTilesetOptions extends ffi.Struct {
 
   @ffi.Uint32()
   external int loadingDescendantLimit;
+
+  @ffi.Bool()
+  external bool cancelStaleTileLoads;
+
+  @ffi.Uint32()
+  external int maxRetries;
+
+  @ffi.Uint32()
+  external int retryBaseDelayMs;
+
+  @ffi.Double()
+  external double hedgePercentile;
+
+  @ffi.Bool()
+  external bool cacheDecodedModels;
 }
 
 final class CesiumTilesetRenderableTiles extends ffi.Struct {
@@ -447,3 +556,289 @@ final class SerializedCesiumGltfModel extends ffi.Struct {
   @ffi.Size()
   external int length;
 }
+
+abstract class CesiumHttpVersion {
+  static const int CT_HTTP_1_1 = 0;
+  static const int CT_HTTP_2 = 1;
+  static const int CT_HTTP_2_PRIOR_KNOWLEDGE = 2;
+}
+
+abstract class CesiumHttpBackend {
+  static const int CT_HTTP_BACKEND_CURL = 0;
+  static const int CT_HTTP_BACKEND_HTTPLIB = 1;
+}
+
+abstract class CesiumNetworkMode {
+  static const int CT_NETWORK_LIVE = 0;
+  static const int CT_NETWORK_RECORD = 1;
+  static const int CT_NETWORK_REPLAY = 2;
+}
+
+abstract class CesiumCachePolicy {
+  static const int CT_CACHE_LRU = 0;
+  static const int CT_CACHE_EXPIRY_FIRST = 1;
+}
+
+final class CesiumNetworkOptions extends ffi.Struct {
+  @ffi.Bool()
+  external bool shareConnectionCache;
+
+  @ffi.Uint32()
+  external int maxIdleHandles;
+
+  @ffi.Int32()
+  external int httpVersion;
+
+  @ffi.Uint32()
+  external int maxConcurrentStreams;
+
+  @ffi.Uint32()
+  external int maxConnectionsPerHost;
+
+  @ffi.Int32()
+  external int mode;
+
+  external ffi.Pointer<ffi.Char> recordingPath;
+
+  @ffi.Bool()
+  external bool simulateRecordedLatency;
+
+  @ffi.Uint64()
+  external int memoryCacheBytes;
+
+  @ffi.Uint64()
+  external int cacheMaxItems;
+
+  @ffi.Uint64()
+  external int cacheMaxBytes;
+
+  @ffi.Int32()
+  external int cachePolicy;
+
+  @ffi.Uint32()
+  external int cachePruneInterval;
+
+  @ffi.Uint32()
+  external int negativeCacheTtlSeconds;
+
+  @ffi.Uint32()
+  external int negativeCacheMaxEntries;
+
+  @ffi.Int32()
+  external int httpBackend;
+}
+
+final class CesiumConnectionStats extends ffi.Struct {
+  @ffi.Uint64()
+  external int requests;
+
+  @ffi.Uint64()
+  external int newConnections;
+
+  @ffi.Uint64()
+  external int reusedConnections;
+
+  @ffi.Uint64()
+  external int reusedHandles;
+
+  @ffi.Uint64()
+  external int cancelledRequests;
+
+  @ffi.Uint64()
+  external int bytesSavedByCancellation;
+
+  @ffi.Uint64()
+  external int revalidations;
+
+  @ffi.Uint64()
+  external int notModifiedResponses;
+
+  @ffi.Uint64()
+  external int bytesSavedByRevalidation;
+}
+
+final class CesiumNetworkHistogram extends ffi.Struct {
+  @ffi.Uint64()
+  external int count;
+
+  @ffi.Uint64()
+  external int sum;
+
+  @ffi.Uint64()
+  external int max;
+
+  @ffi.Array.multi([32])
+  external ffi.Array<ffi.Uint64> buckets;
+}
+
+final class CesiumNetworkStats extends ffi.Struct {
+  external CesiumNetworkHistogram dnsTime;
+
+  external CesiumNetworkHistogram connectTime;
+
+  external CesiumNetworkHistogram tlsTime;
+
+  external CesiumNetworkHistogram timeToFirstByte;
+
+  external CesiumNetworkHistogram totalTime;
+
+  external CesiumNetworkHistogram responseBytes;
+
+  @ffi.Uint64()
+  external int http1Requests;
+
+  @ffi.Uint64()
+  external int http2Requests;
+
+  @ffi.Uint64()
+  external int http3Requests;
+
+  external CesiumNetworkHistogram decodeTime;
+
+  @ffi.Uint64()
+  external int gzipResponses;
+
+  @ffi.Uint64()
+  external int brotliResponses;
+
+  @ffi.Uint64()
+  external int zstdResponses;
+
+  @ffi.Uint64()
+  external int compressedBytes;
+
+  @ffi.Uint64()
+  external int decodedBytes;
+}
+
+final class CesiumTilesetRequestStats extends ffi.Struct {
+  @ffi.Uint64()
+  external int requests;
+
+  @ffi.Uint64()
+  external int retries;
+
+  @ffi.Uint64()
+  external int hedges;
+
+  @ffi.Uint64()
+  external int hedgeWins;
+
+  @ffi.Uint64()
+  external int failures;
+}
+
+final class CesiumCacheStats extends ffi.Struct {
+  @ffi.Uint64()
+  external int memoryHits;
+
+  @ffi.Uint64()
+  external int memoryMisses;
+
+  @ffi.Uint64()
+  external int memoryEvictions;
+
+  @ffi.Uint64()
+  external int memoryEntries;
+
+  @ffi.Uint64()
+  external int memoryBytes;
+
+  @ffi.Uint64()
+  external int hits;
+
+  @ffi.Uint64()
+  external int misses;
+
+  @ffi.Uint64()
+  external int entries;
+
+  @ffi.Uint64()
+  external int bytes;
+
+  @ffi.Uint64()
+  external int pendingEntries;
+
+  @ffi.Uint64()
+  external int prunes;
+
+  @ffi.Uint64()
+  external int prunedEntries;
+
+  external CesiumNetworkHistogram lookupTime;
+
+  external CesiumNetworkHistogram pruneTime;
+
+  external CesiumNetworkHistogram commitTime;
+
+  @ffi.Uint64()
+  external int decodedModelHits;
+
+  @ffi.Uint64()
+  external int decodedModelStores;
+
+  @ffi.Uint64()
+  external int negativeHits;
+
+  @ffi.Uint64()
+  external int negativeEntries;
+}
+
+final class CesiumSeedOptions extends ffi.Struct {
+  @ffi.Double()
+  external double west;
+
+  @ffi.Double()
+  external double south;
+
+  @ffi.Double()
+  external double east;
+
+  @ffi.Double()
+  external double north;
+
+  @ffi.Double()
+  external double minHeight;
+
+  @ffi.Double()
+  external double maxHeight;
+
+  @ffi.Double()
+  external double maximumScreenSpaceError;
+
+  @ffi.Uint32()
+  external int viewpointsPerAxis;
+
+  @ffi.Uint32()
+  external int maxConcurrentRequests;
+
+  external ffi.Pointer<ffi.Char> statePath;
+}
+
+abstract class CesiumSeedState {
+  static const int CT_SEED_RUNNING = 0;
+  static const int CT_SEED_DONE = 1;
+  static const int CT_SEED_CANCELLED = 2;
+  static const int CT_SEED_FAILED = 3;
+}
+
+final class CesiumSeedProgress extends ffi.Struct {
+  @ffi.Int32()
+  external int state;
+
+  @ffi.Uint32()
+  external int completedViewpoints;
+
+  @ffi.Uint32()
+  external int totalViewpoints;
+
+  @ffi.Uint64()
+  external int requests;
+
+  @ffi.Uint64()
+  external int bytes;
+}
+
+final class CesiumSeed extends ffi.Opaque {}
+
+const int CESIUM_NETWORK_HISTOGRAM_BUCKETS = 32;
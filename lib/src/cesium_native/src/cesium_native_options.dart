@@ -1,12 +1,139 @@
+/// The HTTP version negotiated for tile requests.
+enum CesiumHttpVersion {
+  /// HTTP/1.1 only
+  http1_1,
+
+  /// HTTP/2 over TLS, falling back to HTTP/1.1 for http:// URLs
+  http2,
+
+  /// HTTP/2 for every URL, including cleartext (h2c)
+  http2PriorKnowledge,
+}
+
+/// The HTTP client that sends tile requests.
+enum CesiumHttpBackend {
+  /// libcurl, with transfers multiplexed on one I/O thread
+  curl,
+
+  /// cpp-httplib keep-alive clients. Each request occupies an I/O thread
+  /// (see [CesiumNativeOptions.numIoThreads]) while it runs. Connection
+  /// sharing, HTTP/2, connection statistics and the cancellation of stale
+  /// tile loads are only available with [curl].
+  httplib,
+}
+
+/// Where tile requests are answered from.
+enum CesiumNetworkMode {
+  /// Fetch from the network
+  live,
+
+  /// Fetch from the network and record every response to the recording file
+  record,
+
+  /// Answer only from the recording file, without network access
+  replay,
+}
+
+/// Which tile cache entries are removed first once the cache is over budget.
+/// Expired entries are always removed.
+enum CesiumCachePolicy {
+  /// The entries that were not used for the longest time
+  leastRecentlyUsed,
+
+  /// The entries closest to expiring
+  expiryFirst,
+}
+
 class CesiumNativeOptions {
-  /// The path where the SQLite cache database will be stored
+  /// The path where the SQLite cache database will be stored. If this is a
+  /// directory (an existing one, or a path ending in a separator), tile
+  /// bodies are stored in it as individual files and the database only holds
+  /// their metadata, which keeps pruning a large cache fast.
   final String? cacheDbPath;
 
-  /// Number of threads to use for processing tasks
+  /// Number of threads for CPU-bound work such as decoding tile content
+  /// (0 uses one per core, minus one for the UI thread)
   final int numThreads;
 
+  /// Number of threads for blocking I/O such as tile cache reads and writes
+  /// and local files
+  final int numIoThreads;
+
+  /// Share TLS sessions between all tile requests (connections and DNS
+  /// lookups are always shared)
+  final bool shareConnectionCache;
+
+  /// Number of finished request handles kept for reuse (0 disables reuse)
+  final int maxIdleHandles;
+
+  /// The HTTP version to negotiate. With HTTP/2, concurrent tile requests to
+  /// the same host are multiplexed over a single connection.
+  final CesiumHttpVersion httpVersion;
+
+  /// Maximum number of HTTP/2 streams multiplexed over one connection
+  final int maxConcurrentStreams;
+
+  /// Maximum number of connections opened to one host (0 means unlimited)
+  final int maxConnectionsPerHost;
+
+  /// Whether to record tile requests to, or replay them from, [recordingPath]
+  final CesiumNetworkMode networkMode;
+
+  /// The recording file used by [CesiumNetworkMode.record] and
+  /// [CesiumNetworkMode.replay]
+  final String? recordingPath;
+
+  /// When replaying, deliver each response after its recorded latency
+  final bool simulateRecordedLatency;
+
+  /// Size in bytes of the in-memory tier in front of the SQLite cache, which
+  /// serves recently used tiles without a database query (0 disables it)
+  final int memoryCacheBytes;
+
+  /// Maximum number of entries kept in the SQLite cache (0 means unlimited).
+  /// Decoded tile models (`TilesetOptions.cacheDecodedModels`) are entries too
+  final int cacheMaxItems;
+
+  /// Maximum total size in bytes of the tiles kept in the SQLite cache
+  /// (0 means unlimited)
+  final int cacheMaxBytes;
+
+  /// Which entries are removed first when the cache is over budget
+  final CesiumCachePolicy cachePolicy;
+
+  /// The cache is pruned down to its budget after this many requests
+  /// (0 prunes only on [CesiumNative.pruneCache])
+  final int cachePruneInterval;
+
+  /// How long URLs answered with 404 Not Found or 410 Gone are remembered and
+  /// answered locally (0 disables this)
+  final Duration negativeCacheTtl;
+
+  /// Maximum number of missing URLs remembered
+  final int negativeCacheMaxEntries;
+
+  /// The HTTP client that sends tile requests
+  final CesiumHttpBackend httpBackend;
+
   const CesiumNativeOptions({
     this.cacheDbPath,
-    this.numThreads = 16,
+    this.numThreads = 0,
+    this.numIoThreads = 4,
+    this.shareConnectionCache = true,
+    this.maxIdleHandles = 32,
+    this.httpVersion = CesiumHttpVersion.http2,
+    this.maxConcurrentStreams = 100,
+    this.maxConnectionsPerHost = 0,
+    this.networkMode = CesiumNetworkMode.live,
+    this.recordingPath,
+    this.simulateRecordedLatency = false,
+    this.memoryCacheBytes = 64 * 1024 * 1024,
+    this.cacheMaxItems = 4096,
+    this.cacheMaxBytes = 0,
+    this.cachePolicy = CesiumCachePolicy.leastRecentlyUsed,
+    this.cachePruneInterval = 10000,
+    this.negativeCacheTtl = const Duration(hours: 1),
+    this.negativeCacheMaxEntries = 10000,
+    this.httpBackend = CesiumHttpBackend.curl,
   });
 }
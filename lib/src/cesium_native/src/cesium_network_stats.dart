@@ -0,0 +1,200 @@
+/// Connection reuse counters for all tile requests since initialization.
+class CesiumConnectionStats {
+  final int requests;
+  final int newConnections;
+  final int reusedConnections;
+
+  /// Request handles reused from the idle pool. Unrelated to connection
+  /// reuse, which [reusedConnections] counts.
+  final int reusedHandles;
+
+  /// The number of tile requests cancelled because the tile left the view.
+  final int cancelledRequests;
+
+  /// Bytes not downloaded because their request was cancelled.
+  final int bytesSavedByCancellation;
+
+  /// Conditional requests sent to revalidate stale cache entries.
+  final int revalidations;
+
+  /// Revalidations answered with 304 Not Modified.
+  final int notModifiedResponses;
+
+  /// Cached bytes that did not have to be downloaded again thanks to a 304.
+  final int bytesSavedByRevalidation;
+
+  /// The fraction of requests that were sent over an already-open connection.
+  double get connectionReuseRate =>
+      requests == 0 ? 0.0 : reusedConnections / requests;
+
+  CesiumConnectionStats(
+      this.requests,
+      this.newConnections,
+      this.reusedConnections,
+      this.reusedHandles,
+      this.cancelledRequests,
+      this.bytesSavedByCancellation,
+      this.revalidations,
+      this.notModifiedResponses,
+      this.bytesSavedByRevalidation);
+}
+
+/// Retry and hedged request counters for a single tileset.
+class CesiumTilesetRequestStats {
+  final int requests;
+  final int retries;
+  final int hedges;
+
+  /// Hedged requests that completed before the request they duplicated.
+  final int hedgeWins;
+
+  /// Requests that still failed after all retries.
+  final int failures;
+
+  CesiumTilesetRequestStats(
+      this.requests, this.retries, this.hedges, this.hedgeWins, this.failures);
+}
+
+/// A histogram with power-of-two buckets: `buckets[0]` counts zeros and
+/// `buckets[i]` counts values in [2^(i-1), 2^i). The last bucket also counts
+/// all larger values.
+class CesiumNetworkHistogram {
+  final int count;
+  final int sum;
+  final int max;
+  final List<int> buckets;
+
+  double get mean => count == 0 ? 0.0 : sum / count;
+
+  /// An upper bound for the [p]th percentile (0-1), i.e. the upper edge of the
+  /// bucket that contains it.
+  int percentile(double p) {
+    if (count == 0) {
+      return 0;
+    }
+    final target = (p * count).ceil().clamp(1, count);
+    var seen = 0;
+    for (int i = 0; i < buckets.length; i++) {
+      seen += buckets[i];
+      if (seen >= target) {
+        return i == buckets.length - 1 ? max : (1 << i) - 1;
+      }
+    }
+    return max;
+  }
+
+  CesiumNetworkHistogram(this.count, this.sum, this.max, this.buckets);
+}
+
+/// Per-request timing breakdown of network requests. Times are in
+/// microseconds. DNS, connect and TLS times are only recorded for requests
+/// that opened a new connection.
+class CesiumNetworkStats {
+  final CesiumNetworkHistogram dnsTime;
+  final CesiumNetworkHistogram connectTime;
+  final CesiumNetworkHistogram tlsTime;
+  final CesiumNetworkHistogram timeToFirstByte;
+  final CesiumNetworkHistogram totalTime;
+  final CesiumNetworkHistogram responseBytes;
+  final int http1Requests;
+  final int http2Requests;
+  final int http3Requests;
+
+  /// Time spent decoding compressed responses.
+  final CesiumNetworkHistogram decodeTime;
+
+  /// Responses received per Content-Encoding (deflate is counted as gzip).
+  final int gzipResponses;
+  final int brotliResponses;
+  final int zstdResponses;
+
+  /// Size of compressed responses before and after decoding.
+  final int compressedBytes;
+  final int decodedBytes;
+
+  /// Compressed size as a fraction of the decoded size (1.0 if nothing was
+  /// compressed).
+  double get compressionRatio =>
+      decodedBytes == 0 ? 1.0 : compressedBytes / decodedBytes;
+
+  CesiumNetworkStats(
+      this.dnsTime,
+      this.connectTime,
+      this.tlsTime,
+      this.timeToFirstByte,
+      this.totalTime,
+      this.responseBytes,
+      this.http1Requests,
+      this.http2Requests,
+      this.http3Requests,
+      this.decodeTime,
+      this.gzipResponses,
+      this.brotliResponses,
+      this.zstdResponses,
+      this.compressedBytes,
+      this.decodedBytes);
+}
+
+/// Tile cache counters. Hit, miss and prune counters and the histograms cover
+/// the time since initialization or the last reset; entry and byte counts are
+/// current values. Times are in microseconds.
+class CesiumCacheStats {
+  /// Lookups answered by the in-memory tier, which is consulted first.
+  final int memoryHits;
+  final int memoryMisses;
+  final int memoryEvictions;
+  final int memoryEntries;
+  final int memoryBytes;
+
+  /// Lookups answered by the SQLite cache (only reached on a memory miss).
+  final int hits;
+  final int misses;
+  final int entries;
+
+  /// Total size of the stored tiles.
+  final int bytes;
+
+  /// Entries not yet written to disk.
+  final int pendingEntries;
+  final int prunes;
+  final int prunedEntries;
+  final CesiumNetworkHistogram lookupTime;
+  final CesiumNetworkHistogram pruneTime;
+  final CesiumNetworkHistogram commitTime;
+
+  /// Tile models loaded without decoding, see
+  /// `TilesetOptions.cacheDecodedModels`.
+  final int decodedModelHits;
+  final int decodedModelStores;
+
+  /// Requests answered with a remembered 404 Not Found or 410 Gone.
+  final int negativeHits;
+  final int negativeEntries;
+
+  double get memoryHitRate => memoryHits + memoryMisses == 0
+      ? 0.0
+      : memoryHits / (memoryHits + memoryMisses);
+
+  double get hitRate => hits + misses == 0 ? 0.0 : hits / (hits + misses);
+
+  CesiumCacheStats(
+      this.memoryHits,
+      this.memoryMisses,
+      this.memoryEvictions,
+      this.memoryEntries,
+      this.memoryBytes,
+      this.hits,
+      this.misses,
+      this.entries,
+      this.bytes,
+      this.pendingEntries,
+      this.prunes,
+      this.prunedEntries,
+      this.lookupTime,
+      this.pruneTime,
+      this.commitTime,
+      this.decodedModelHits,
+      this.decodedModelStores,
+      this.negativeHits,
+      this.negativeEntries);
+}
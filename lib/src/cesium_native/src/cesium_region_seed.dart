@@ -0,0 +1,68 @@
+///
+/// A region to pre-load into the tile cache with [CesiumNative.seedRegion],
+/// so it can be viewed without network access later. Angles are in degrees,
+/// heights in meters above the WGS84 ellipsoid. A region with [east] less
+/// than [west] crosses the antimeridian.
+///
+class CesiumSeedRegion {
+  final double west;
+  final double south;
+  final double east;
+  final double north;
+  final double minHeight;
+  final double maxHeight;
+
+  ///
+  /// Tiles are loaded as if the region were viewed at this screen-space
+  /// error. Use the value the tileset will be displayed with.
+  ///
+  final double maximumScreenSpaceError;
+
+  ///
+  /// The region is covered by a grid of viewpointsPerAxis x viewpointsPerAxis
+  /// synthetic cameras looking straight down.
+  ///
+  final int viewpointsPerAxis;
+
+  ///
+  /// The maximum number of tiles loaded at the same time.
+  ///
+  final int maxConcurrentRequests;
+
+  ///
+  /// A file that records which viewpoints have been completed. If set,
+  /// seeding the same region again continues where an interrupted run
+  /// stopped.
+  ///
+  final String? statePath;
+
+  CesiumSeedRegion(
+      {required this.west,
+      required this.south,
+      required this.east,
+      required this.north,
+      this.minHeight = 0,
+      this.maxHeight = 0,
+      this.maximumScreenSpaceError = 16.0,
+      this.viewpointsPerAxis = 4,
+      this.maxConcurrentRequests = 20,
+      this.statePath});
+}
+
+enum CesiumSeedState { Running, Done, Cancelled, Failed }
+
+class CesiumSeedProgress {
+  final CesiumSeedState state;
+  final int completedViewpoints;
+  final int totalViewpoints;
+
+  /// Responses received, including ones that were already cached.
+  final int requests;
+  final int bytes;
+
+  double get fraction =>
+      totalViewpoints == 0 ? 1.0 : completedViewpoints / totalViewpoints;
+
+  CesiumSeedProgress(this.state, this.completedViewpoints, this.totalViewpoints,
+      this.requests, this.bytes);
+}
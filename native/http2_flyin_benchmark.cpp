@@ -0,0 +1,320 @@
+// Compares how long a camera fly-in takes to converge when CurlAssetAccessor loads its tiles over
+// HTTP/1.1 and over HTTP/2 with prior knowledge (h2c), both from a loopback server.
+//
+// Build (from native/, against the prebuilt Cesium Native libraries downloaded by hook/build.dart):
+//   g++ -std=c++17 -O2 -Iinclude -Igenerated/include -Ithirdparty/include http2_flyin_benchmark.cpp -o http2_flyin_benchmark
+//       -L<cesium native lib dir> -lCesiumAsync -lasync++ -lspdlog -lfmt -lcurl -lssl -lcrypto -lz -lpthread
+// Run:
+//   ./http2_flyin_benchmark [levels] [runs]
+//
+// The HTTP/1.1 runs are served by cpp-httplib inside this process, the h2c runs by nghttpd (from
+// nghttp2), which has to be on the PATH. Both serve the same files from a temporary directory.
+//
+// The fly-in descends one level of a quadtree every 10 frames (16 ms each) towards a fixed point,
+// with at most 20 tile loads in flight like Tileset's default maximumSimultaneousTileLoads. Tiles
+// that leave the view before their load started are never requested. It has converged once every
+// tile of the final view has loaded.
+//
+// Loopback has practically no round-trip time, which hides most of what multiplexing saves. For
+// WAN-like numbers delay the loopback device first, e.g.
+//   sudo tc qdisc add dev lo root netem delay 20ms
+// and remove the delay again with `sudo tc qdisc del dev lo root`.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <httplib.h>
+
+#include "CurlAssetAccessor.hpp"
+#include "WorkStealingTaskProcessor.hpp"
+
+extern char** environ;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint32_t kFramesPerLevel = 10;
+static constexpr std::chrono::milliseconds kFrameTime(16);
+static constexpr size_t kMaxSimultaneousLoads = 20;
+// The point the camera flies towards, in [0, 1) tile coordinates.
+static constexpr double kTargetX = 0.37;
+static constexpr double kTargetY = 0.61;
+
+struct QuadtreeTile {
+    uint32_t level;
+    uint32_t x;
+    uint32_t y;
+};
+
+static std::string tilePath(const QuadtreeTile& tile) {
+    return "/tiles/" + std::to_string(tile.level) + "/" + std::to_string(tile.x) + "/" + std::to_string(tile.y) + ".b3dm";
+}
+
+// The 3x3 tiles around the target at one level, like a camera looking straight down at it.
+static std::vector<QuadtreeTile> visibleTiles(uint32_t level) {
+    int64_t count = int64_t(1) << level;
+    int64_t centerX = static_cast<int64_t>(kTargetX * static_cast<double>(count));
+    int64_t centerY = static_cast<int64_t>(kTargetY * static_cast<double>(count));
+    std::vector<QuadtreeTile> tiles;
+    for (int64_t y = centerY - 1; y <= centerY + 1; y++) {
+        for (int64_t x = centerX - 1; x <= centerX + 1; x++) {
+            if (x >= 0 && y >= 0 && x < count && y < count) {
+                tiles.push_back(QuadtreeTile { level, static_cast<uint32_t>(x), static_cast<uint32_t>(y) });
+            }
+        }
+    }
+    return tiles;
+}
+
+// Writes every tile the fly-in can request, 20-120 KB of incompressible bytes each.
+static void writeTiles(const std::filesystem::path& root, uint32_t levels) {
+    for (uint32_t level = 0; level <= levels; level++) {
+        for (const QuadtreeTile& tile : visibleTiles(level)) {
+            std::filesystem::path path = root / tilePath(tile).substr(1);
+            std::filesystem::create_directories(path.parent_path());
+            std::mt19937 random(level * 1000003u + tile.x * 1009u + tile.y);
+            std::vector<char> data(20 * 1024 + random() % (100 * 1024));
+            for (char& byte : data) {
+                byte = static_cast<char>(random());
+            }
+            std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+    }
+}
+
+class Http1Server {
+public:
+    explicit Http1Server(const std::string& root) {
+        _server.set_mount_point("/", root);
+        // one connection per concurrent tile load; each needs its own thread
+        _server.new_task_queue = [] { return new httplib::ThreadPool(kMaxSimultaneousLoads * 2); };
+        _server.set_keep_alive_max_count(100000);
+        _port = _server.bind_to_any_port("127.0.0.1");
+        if (_port < 0) {
+            throw std::runtime_error("Failed to bind the HTTP/1.1 server");
+        }
+        _thread = std::thread([this]() { _server.listen_after_bind(); });
+        _server.wait_until_ready();
+    }
+
+    ~Http1Server() {
+        _server.stop();
+        _thread.join();
+    }
+
+    std::string baseUrl() const {
+        return "http://127.0.0.1:" + std::to_string(_port);
+    }
+
+private:
+    httplib::Server _server;
+    std::thread _thread;
+    int _port = -1;
+};
+
+class H2cServer {
+public:
+    explicit H2cServer(const std::string& root) : _port(freePort()) {
+        std::string port = std::to_string(_port);
+        std::vector<char*> argv { const_cast<char*>("nghttpd"), const_cast<char*>("--no-tls"), const_cast<char*>("-d"),
+            const_cast<char*>(root.c_str()), const_cast<char*>(port.c_str()), nullptr };
+        if (posix_spawnp(&_pid, "nghttpd", nullptr, nullptr, argv.data(), environ) != 0) {
+            throw std::runtime_error("Failed to start nghttpd; is nghttp2 installed?");
+        }
+        waitUntilAccepting();
+    }
+
+    ~H2cServer() {
+        kill(_pid, SIGTERM);
+        waitpid(_pid, nullptr, 0);
+    }
+
+    std::string baseUrl() const {
+        return "http://127.0.0.1:" + std::to_string(_port);
+    }
+
+private:
+    pid_t _pid = 0;
+    int _port;
+
+    static sockaddr_in loopback(int port) {
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        return address;
+    }
+
+    static int freePort() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = loopback(0);
+        socklen_t length = sizeof(address);
+        bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        close(fd);
+        return ntohs(address.sin_port);
+    }
+
+    void waitUntilAccepting() const {
+        for (int attempt = 0; attempt < 100; attempt++) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address = loopback(_port);
+            bool connected = connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            close(fd);
+            if (connected) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        throw std::runtime_error("nghttpd did not start accepting connections");
+    }
+};
+
+struct Result {
+    double seconds = 0;
+    size_t requests = 0;
+    size_t failures = 0;
+    uint64_t connections = 0;
+    uint64_t bytes = 0;
+};
+
+static Result flyIn(const std::string& baseUrl, const CurlAssetAccessorOptions& options, uint32_t levels) {
+    auto pTaskProcessor = std::make_shared<WorkStealingTaskProcessor>(2);
+    CesiumAsync::AsyncSystem asyncSystem(pTaskProcessor);
+    auto pAccessor = std::make_shared<CurlAssetAccessor>(options);
+
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::set<std::string> started;
+    std::set<std::string> loaded;
+    size_t inFlight = 0;
+    Result result;
+
+    auto start = Clock::now();
+    for (uint32_t frame = 0;; frame++) {
+        uint32_t level = std::min(levels, frame / kFramesPerLevel);
+        std::vector<std::string> requests;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<QuadtreeTile> visible = visibleTiles(level);
+            bool converged = frame / kFramesPerLevel >= levels &&
+                std::all_of(visible.begin(), visible.end(), [&](const QuadtreeTile& tile) { return loaded.count(tilePath(tile)) > 0; });
+            if (converged) {
+                result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                break;
+            }
+            for (const QuadtreeTile& tile : visible) {
+                std::string path = tilePath(tile);
+                if (inFlight >= kMaxSimultaneousLoads) {
+                    break;
+                }
+                if (started.insert(path).second) {
+                    inFlight++;
+                    requests.push_back(path);
+                }
+            }
+        }
+
+        // outside the lock: a request that fails immediately completes on this thread
+        for (const std::string& path : requests) {
+            pAccessor->get(asyncSystem, baseUrl + path, {})
+                .thenImmediately([&, path](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                    const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+                    std::lock_guard<std::mutex> lock(mutex);
+                    result.requests++;
+                    if (pResponse && pResponse->statusCode() == 200) {
+                        result.bytes += pResponse->data().size();
+                    } else {
+                        result.failures++;
+                    }
+                    // a failed tile is not retried; it counts as settled so the fly-in still ends
+                    loaded.insert(path);
+                    inFlight--;
+                    idle.notify_all();
+                })
+                .catchImmediately([&, path](std::exception&& e) {
+                    std::fprintf(stderr, "%s failed: %s\n", path.c_str(), e.what());
+                    std::lock_guard<std::mutex> lock(mutex);
+                    result.requests++;
+                    result.failures++;
+                    loaded.insert(path);
+                    inFlight--;
+                    idle.notify_all();
+                });
+        }
+
+        std::this_thread::sleep_until(start + kFrameTime * (frame + 1));
+    }
+
+    // the continuations above refer to this frame's locals
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [&]() { return inFlight == 0; });
+    result.connections = pAccessor->getStats().newConnections;
+    return result;
+}
+
+struct Scenario {
+    const char* name;
+    long httpVersion;
+    long maxConnectionsPerHost;
+    bool h2c;
+};
+
+int main(int argc, char** argv) {
+    uint32_t levels = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 8;
+    int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    spdlog::set_level(spdlog::level::warn);
+
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "cesium_flyin_benchmark";
+    std::filesystem::remove_all(root);
+    writeTiles(root, levels);
+
+    Http1Server http1(root.string());
+    H2cServer h2c(root.string());
+    std::printf("fly-in over %u levels, median of %d runs\n", levels, runs);
+
+    const Scenario scenarios[] = {
+        { "HTTP/1.1", CURL_HTTP_VERSION_1_1, 0, false },
+        { "HTTP/1.1, 6 per host", CURL_HTTP_VERSION_1_1, 6, false },
+        { "h2c", CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE, 0, true },
+    };
+    for (const Scenario& scenario : scenarios) {
+        CurlAssetAccessorOptions options;
+        options.httpVersion = scenario.httpVersion;
+        options.maxConnectionsPerHost = scenario.maxConnectionsPerHost;
+        std::string baseUrl = scenario.h2c ? h2c.baseUrl() : http1.baseUrl();
+
+        std::vector<Result> results;
+        for (int run = 0; run < runs; run++) {
+            results.push_back(flyIn(baseUrl, options, levels));
+        }
+        std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) { return a.seconds < b.seconds; });
+        const Result& median = results[results.size() / 2];
+        std::printf("%-22s converged in %8.1f ms  %4zu requests  %3zu failed  %3llu connections  %7.2f MB\n",
+            scenario.name, median.seconds * 1000.0, median.requests, median.failures,
+            static_cast<unsigned long long>(median.connections), static_cast<double>(median.bytes) / (1024.0 * 1024.0));
+    }
+
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <openssl/evp.h>
+#include <spdlog/spdlog.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include "FileAssetAccessor.hpp"
+
+// A memory-mapped 3D Tiles archive (.3tz): a zip file whose last entry, "@3dtilesIndex1@", is a
+// sorted table of (MD5 of entry path, local file header offset) records. Entries are found by
+// binary search over that table, so opening an entry never touches the central directory.
+class TilesetArchive {
+public:
+    struct Entry {
+        uint16_t compression;
+        uint64_t uncompressedSize;
+        // The entry's (possibly compressed) bytes inside the mapping.
+        gsl::span<const std::byte> data;
+    };
+
+    static constexpr uint16_t kStored = 0;
+    static constexpr uint16_t kDeflate = 8;
+    static constexpr uint16_t kZstd = 93;
+
+    // Maps the archive at path and locates its index. Returns nullptr if the file does not exist.
+    static std::shared_ptr<TilesetArchive> open(const std::string& path) {
+        auto pFile = MappedFile::open(path);
+        if (!pFile) {
+            return nullptr;
+        }
+        auto pArchive = std::shared_ptr<TilesetArchive>(new TilesetArchive(path, std::move(pFile)));
+        pArchive->readIndex();
+        return pArchive;
+    }
+
+    // Looks up an entry by its path inside the archive, e.g. "tileset.json" or "tiles/0/0.glb".
+    std::optional<Entry> find(const std::string& entryPath) const {
+        std::array<unsigned char, 16> hash = md5(entryPath);
+        uint64_t hashLow = readU64(reinterpret_cast<const std::byte*>(hash.data()));
+        uint64_t hashHigh = readU64(reinterpret_cast<const std::byte*>(hash.data()) + 8);
+
+        size_t low = 0;
+        size_t high = _index.size() / kIndexRecordSize;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            const std::byte* record = _index.data() + mid * kIndexRecordSize;
+            uint64_t recordLow = readU64(record);
+            uint64_t recordHigh = readU64(record + 8);
+            if (recordLow < hashLow || (recordLow == hashLow && recordHigh < hashHigh)) {
+                low = mid + 1;
+            } else if (recordLow == hashLow && recordHigh == hashHigh) {
+                return readLocalEntry(readU64(record + 16));
+            } else {
+                high = mid;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Returns the uncompressed contents of an entry. Stored entries are returned as a view of the
+    // mapping; compressed entries are inflated into a new buffer, which is kept alive by pOwner.
+    // Entries that do not decompress to exactly their stated size are rejected.
+    gsl::span<const std::byte> read(const Entry& entry, std::shared_ptr<const void>& pOwner) const {
+        if (entry.compression == kStored) {
+            return entry.data;
+        }
+
+        auto pBuffer = std::make_shared<std::vector<std::byte>>();
+        if (entry.compression == kDeflate) {
+            inflateEntry(entry, *pBuffer);
+        } else if (entry.compression == kZstd) {
+            decompressZstdEntry(entry, *pBuffer);
+        } else {
+            throw std::runtime_error("Unsupported compression method " + std::to_string(entry.compression) + " in " + _path);
+        }
+        if (pBuffer->size() != entry.uncompressedSize) {
+            throw std::runtime_error("Entry in " + _path + " does not decompress to its stated size of " +
+                std::to_string(entry.uncompressedSize) + " bytes");
+        }
+        pOwner = pBuffer;
+        return gsl::span<const std::byte>(pBuffer->data(), pBuffer->size());
+    }
+
+private:
+    static constexpr size_t kIndexRecordSize = 24;
+    static constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+    static constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+    static constexpr uint32_t kEndOfCentralDirectorySignature = 0x06054b50;
+    static constexpr uint32_t kZip64LocatorSignature = 0x07064b50;
+    static constexpr uint32_t kZip64EndOfCentralDirectorySignature = 0x06064b50;
+
+    std::string _path;
+    std::shared_ptr<MappedFile> _pFile;
+    gsl::span<const std::byte> _index;
+
+    TilesetArchive(const std::string& path, std::shared_ptr<MappedFile>&& pFile)
+        : _path(path), _pFile(std::move(pFile)) {}
+
+    // Largest amount of output allocated in one piece. The stated size of an entry is untrusted, so
+    // larger entries grow their buffer as data is actually decoded.
+    static constexpr uint64_t kMaxPresizedEntryBytes = 64 * 1024 * 1024;
+
+    // How much the output buffer of a compressed entry may grow by next. Output stops one byte past
+    // the stated size, so that an entry decoding to more than that is caught without decoding all of it.
+    static size_t outputRoom(size_t written, uint64_t uncompressedSize) {
+        uint64_t limit = uncompressedSize == UINT64_MAX ? UINT64_MAX : uncompressedSize + 1;
+        if (written >= limit) {
+            return 0;
+        }
+        return static_cast<size_t>(std::min<uint64_t>({ limit - written, kMaxPresizedEntryBytes, UINT_MAX }));
+    }
+
+    void inflateEntry(const Entry& entry, std::vector<std::byte>& output) const {
+        z_stream stream {};
+        // negative window bits: raw deflate data without a zlib header
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            throw std::runtime_error("Failed to initialize zlib");
+        }
+        const std::byte* input = entry.data.data();
+        size_t inputLeft = entry.data.size();
+        int result = Z_OK;
+        while (result == Z_OK) {
+            size_t written = output.size();
+            size_t room = outputRoom(written, entry.uncompressedSize);
+            if (room == 0) {
+                break;
+            }
+            output.resize(written + room);
+            if (stream.avail_in == 0) {
+                // zlib counts input in uInt, which does not cover zip64 entries
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(input));
+                stream.avail_in = static_cast<uInt>(std::min<size_t>(inputLeft, UINT_MAX));
+                input += stream.avail_in;
+                inputLeft -= stream.avail_in;
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(output.data() + written);
+            stream.avail_out = static_cast<uInt>(room);
+            result = inflate(&stream, Z_NO_FLUSH);
+            output.resize(written + room - stream.avail_out);
+        }
+        inflateEnd(&stream);
+        // Z_OK here means the output limit was reached; read() reports the size mismatch
+        if (result != Z_STREAM_END && result != Z_OK) {
+            throw std::runtime_error("Failed to inflate entry in " + _path);
+        }
+    }
+
+    void decompressZstdEntry(const Entry& entry, std::vector<std::byte>& output) const {
+        std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)> pStream(ZSTD_createDStream(), ZSTD_freeDStream);
+        ZSTD_inBuffer input { entry.data.data(), entry.data.size(), 0 };
+        size_t result = 1;
+        while (input.pos < input.size || result != 0) {
+            size_t written = output.size();
+            size_t room = outputRoom(written, entry.uncompressedSize);
+            if (room == 0) {
+                break;
+            }
+            output.resize(written + room);
+            ZSTD_outBuffer out { output.data() + written, room, 0 };
+            result = ZSTD_decompressStream(pStream.get(), &out, &input);
+            output.resize(written + out.pos);
+            if (ZSTD_isError(result)) {
+                throw std::runtime_error("Failed to decompress entry in " + _path + ": " + ZSTD_getErrorName(result));
+            }
+            if (input.pos == input.size && out.pos == 0 && result != 0) {
+                throw std::runtime_error("Truncated entry in " + _path);
+            }
+        }
+    }
+
+    static uint16_t readU16(const std::byte* p) {
+        return static_cast<uint16_t>(static_cast<uint16_t>(p[0]) | static_cast<uint16_t>(p[1]) << 8);
+    }
+
+    static uint32_t readU32(const std::byte* p) {
+        return static_cast<uint32_t>(readU16(p)) | static_cast<uint32_t>(readU16(p + 2)) << 16;
+    }
+
+    static uint64_t readU64(const std::byte* p) {
+        return static_cast<uint64_t>(readU32(p)) | static_cast<uint64_t>(readU32(p + 4)) << 32;
+    }
+
+    static std::array<unsigned char, 16> md5(const std::string& value) {
+        std::array<unsigned char, 16> hash {};
+        unsigned int length = 0;
+        if (!EVP_Digest(value.data(), value.size(), hash.data(), &length, EVP_md5(), nullptr)) {
+            throw std::runtime_error("Failed to compute MD5");
+        }
+        return hash;
+    }
+
+    // Returns size bytes at offset, throwing if they are not inside the archive.
+    const std::byte* at(uint64_t offset, uint64_t size) const {
+        gsl::span<const std::byte> data = _pFile->data();
+        if (offset > data.size() || size > data.size() - offset) {
+            throw std::runtime_error(_path + " is truncated or not a valid 3D Tiles archive");
+        }
+        return data.data() + offset;
+    }
+
+    void readIndex() {
+        gsl::span<const std::byte> data = _pFile->data();
+
+        // the end of central directory record is followed only by a comment of at most 64KB
+        const size_t kEndRecordSize = 22;
+        if (data.size() < kEndRecordSize) {
+            throw std::runtime_error(_path + " is not a zip archive");
+        }
+        std::optional<size_t> endRecord;
+        size_t lowest = data.size() - kEndRecordSize > 0xFFFF ? data.size() - kEndRecordSize - 0xFFFF : 0;
+        for (size_t offset = data.size() - kEndRecordSize + 1; offset-- > lowest;) {
+            if (readU32(data.data() + offset) == kEndOfCentralDirectorySignature) {
+                endRecord = offset;
+                break;
+            }
+        }
+        if (!endRecord) {
+            throw std::runtime_error(_path + " is not a zip archive");
+        }
+
+        const std::byte* end = data.data() + *endRecord;
+        uint64_t entryCount = readU16(end + 10);
+        uint64_t directoryOffset = readU32(end + 16);
+        if ((entryCount == 0xFFFF || directoryOffset == 0xFFFFFFFF) && *endRecord >= 20) {
+            // zip64: archives with more than 65535 entries or larger than 4GB
+            const std::byte* locator = data.data() + *endRecord - 20;
+            if (readU32(locator) == kZip64LocatorSignature) {
+                const std::byte* end64 = at(readU64(locator + 8), 56);
+                if (readU32(end64) != kZip64EndOfCentralDirectorySignature) {
+                    throw std::runtime_error(_path + " has an invalid zip64 end of central directory");
+                }
+                entryCount = readU64(end64 + 32);
+                directoryOffset = readU64(end64 + 48);
+            }
+        }
+
+        // The index is the last entry, so the central directory has to be walked once to find it.
+        // Every later lookup goes through the index.
+        static const std::string kIndexName = "@3dtilesIndex1@";
+        std::optional<uint64_t> indexHeader;
+        uint64_t offset = directoryOffset;
+        for (uint64_t i = 0; i < entryCount; i++) {
+            const std::byte* header = at(offset, 46);
+            if (readU32(header) != kCentralHeaderSignature) {
+                throw std::runtime_error(_path + " has an invalid central directory");
+            }
+            uint16_t nameLength = readU16(header + 28);
+            uint16_t extraLength = readU16(header + 30);
+            uint16_t commentLength = readU16(header + 32);
+            const char* name = reinterpret_cast<const char*>(at(offset + 46, nameLength));
+            if (nameLength == kIndexName.size() && std::memcmp(name, kIndexName.data(), nameLength) == 0) {
+                uint64_t headerOffset = readU32(header + 42);
+                if (headerOffset == 0xFFFFFFFF) {
+                    headerOffset = readZip64Field(at(offset + 46 + nameLength, extraLength), extraLength, header + 24, header + 20, header + 42);
+                }
+                indexHeader = headerOffset;
+            }
+            offset += 46 + nameLength + extraLength + commentLength;
+        }
+        if (!indexHeader) {
+            throw std::runtime_error(_path + " has no " + kIndexName + " entry; it is a zip file but not a 3D Tiles archive");
+        }
+
+        std::optional<Entry> index = readLocalEntry(*indexHeader);
+        if (!index || index->compression != kStored || index->data.size() % kIndexRecordSize != 0) {
+            throw std::runtime_error(_path + " has an invalid " + kIndexName + " entry");
+        }
+        _index = index->data;
+    }
+
+    // Reads a zip64 extended information extra field. Only the fields whose 32-bit value in the
+    // header is 0xFFFFFFFF are present, in the order uncompressed size, compressed size, offset.
+    // Returns the value for the last of the given 32-bit fields.
+    static uint64_t readZip64Field(const std::byte* extra, uint16_t extraLength, const std::byte* uncompressedSize, const std::byte* compressedSize, const std::byte* headerOffset) {
+        size_t position = 0;
+        while (position + 4 <= extraLength) {
+            uint16_t id = readU16(extra + position);
+            uint16_t size = readU16(extra + position + 2);
+            if (id == 0x0001) {
+                size_t field = position + 4;
+                uint64_t value = 0;
+                for (const std::byte* original : { uncompressedSize, compressedSize, headerOffset }) {
+                    if (original && readU32(original) == 0xFFFFFFFF && field + 8 <= position + 4 + size) {
+                        value = readU64(extra + field);
+                        field += 8;
+                    }
+                }
+                return value;
+            }
+            position += 4 + size;
+        }
+        throw std::runtime_error("Missing zip64 extra field");
+    }
+
+    std::optional<Entry> readLocalEntry(uint64_t offset) const {
+        const std::byte* header = at(offset, 30);
+        if (readU32(header) != kLocalHeaderSignature) {
+            throw std::runtime_error(_path + " has an index entry that does not point at a file");
+        }
+        uint16_t flags = readU16(header + 6);
+        uint16_t compression = readU16(header + 8);
+        uint64_t compressedSize = readU32(header + 18);
+        uint64_t uncompressedSize = readU32(header + 22);
+        uint16_t nameLength = readU16(header + 26);
+        uint16_t extraLength = readU16(header + 28);
+        const std::byte* extra = at(offset + 30 + nameLength, extraLength);
+
+        if (uncompressedSize == 0xFFFFFFFF) {
+            uncompressedSize = readZip64Field(extra, extraLength, header + 22, nullptr, nullptr);
+        }
+        if (compressedSize == 0xFFFFFFFF) {
+            compressedSize = readZip64Field(extra, extraLength, header + 22, header + 18, nullptr);
+        }
+        if ((flags & 0x08) && compressedSize == 0) {
+            // sizes are only given in a data descriptor after the data
+            throw std::runtime_error(_path + " uses zip data descriptors, which are not supported");
+        }
+
+        uint64_t dataOffset = offset + 30 + nameLength + extraLength;
+        Entry entry;
+        entry.compression = compression;
+        entry.uncompressedSize = uncompressedSize;
+        entry.data = gsl::span<const std::byte>(at(dataOffset, compressedSize), compressedSize);
+        return entry;
+    }
+};
+
+// An IAssetAccessor decorator that serves tiles from local 3D Tiles archives. A URL addresses an
+// entry by appending its path to the archive path, e.g. "file:///data/city.3tz/tileset.json";
+// relative tile URLs then resolve to further entries of the same archive. Archives are opened on
+// first use and stay mapped for the lifetime of the accessor. Lookups and decompression run on
+// worker threads. All other URLs are passed on to the wrapped accessor.
+class ArchiveAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    ArchiveAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor)
+        : _pAssetAccessor(pAssetAccessor) {}
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        std::string archivePath;
+        std::string entryPath;
+        if ((verb != "GET" && verb != "HEAD") || !FileAssetAccessor::isLocal(url) || !splitArchivePath(FileAssetAccessor::getPath(url), archivePath, entryPath)) {
+            return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        }
+
+        return asyncSystem.runInWorkerThread([this, verb, url, headers, archivePath, entryPath]() -> std::shared_ptr<CesiumAsync::IAssetRequest> {
+            std::string contentType = FileAssetAccessor::getContentType(url);
+            std::unique_ptr<FileAssetResponse> pResponse;
+            std::shared_ptr<TilesetArchive> pArchive = getArchive(archivePath);
+            std::optional<TilesetArchive::Entry> entry = pArchive ? pArchive->find(entryPath) : std::nullopt;
+            if (!entry) {
+                pResponse = std::make_unique<FileAssetResponse>(404, contentType);
+            } else if (verb == "HEAD") {
+                pResponse = std::make_unique<FileAssetResponse>(200, contentType);
+            } else {
+                std::shared_ptr<const void> pOwner = pArchive;
+                gsl::span<const std::byte> data = pArchive->read(*entry, pOwner);
+                pResponse = std::make_unique<FileAssetResponse>(200, contentType, data, std::move(pOwner));
+            }
+            return std::make_shared<FileAssetRequest>(
+                verb,
+                url,
+                CesiumAsync::HttpHeaders(headers.begin(), headers.end()),
+                std::move(pResponse));
+        });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<TilesetArchive>> _archives;
+
+    // Splits "/data/city.3tz/tiles/0.glb" into "/data/city.3tz" and "tiles/0.glb".
+    static bool splitArchivePath(const std::string& path, std::string& archivePath, std::string& entryPath) {
+        std::string lower = path;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        size_t extension = std::string::npos;
+        for (size_t position = lower.find(".3tz"); position != std::string::npos; position = lower.find(".3tz", position + 1)) {
+            char next = position + 4 < lower.size() ? lower[position + 4] : '\0';
+            if (next == '/' || next == '\\') {
+                extension = position;
+                break;
+            }
+        }
+        if (extension == std::string::npos) {
+            return false;
+        }
+        archivePath = path.substr(0, extension + 4);
+        entryPath = path.substr(extension + 5);
+        std::replace(entryPath.begin(), entryPath.end(), '\\', '/');
+        while (entryPath.compare(0, 2, "./") == 0) {
+            entryPath = entryPath.substr(2);
+        }
+        return !entryPath.empty();
+    }
+
+    std::shared_ptr<TilesetArchive> getArchive(const std::string& path) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _archives.find(path);
+        if (it != _archives.end()) {
+            return it->second;
+        }
+        std::shared_ptr<TilesetArchive> pArchive = TilesetArchive::open(path);
+        if (pArchive) {
+            spdlog::default_logger()->info("Opened 3D Tiles archive {}", path);
+            _archives.emplace(path, pArchive);
+        }
+        return pArchive;
+    }
+};
@@ -44,6 +44,11 @@ struct CesiumTilesetOptions {
     uint32_t maximumSimultaneousTileLoads;
     uint32_t maximumSimultaneousSubtreeLoads;
     uint32_t loadingDescendantLimit;
+    bool cancelStaleTileLoads; // cancel downloads for tiles that stay culled or unvisited while loading
+    uint32_t maxRetries; // retries for network errors and 408/429/5xx responses, with jittered exponential backoff
+    uint32_t retryBaseDelayMs; // backoff before the first retry; doubles for each further retry
+    double hedgePercentile; // send a duplicate request once a request is slower than this latency percentile (0-100); 0 disables
+    bool cacheDecodedModels; // keep decoded (post-Draco/meshopt) tile models in the tile cache so cache hits skip decoding
 };
 typedef struct CesiumTilesetOptions CesiumTilesetOptions;
 
@@ -161,10 +166,210 @@ struct SerializedCesiumGltfModel {
 };
 typedef struct SerializedCesiumGltfModel SerializedCesiumGltfModel;
 
+// The HTTP version negotiated for tile requests.
+enum CesiumHttpVersion {
+    CT_HTTP_1_1, // HTTP/1.1 only
+    CT_HTTP_2, // HTTP/2 over TLS, falling back to HTTP/1.1 for http:// URLs
+    CT_HTTP_2_PRIOR_KNOWLEDGE, // HTTP/2 for every URL, including cleartext h2c
+};
+typedef enum CesiumHttpVersion CesiumHttpVersion;
+
+// The HTTP client that sends tile requests.
+enum CesiumHttpBackend {
+    CT_HTTP_BACKEND_CURL, // libcurl transfers multiplexed on one I/O thread
+    CT_HTTP_BACKEND_HTTPLIB, // cpp-httplib keep-alive clients; each request occupies an I/O worker thread while it runs
+};
+typedef enum CesiumHttpBackend CesiumHttpBackend;
+
+// Where tile requests are answered from.
+enum CesiumNetworkMode {
+    CT_NETWORK_LIVE, // fetch from the network
+    CT_NETWORK_RECORD, // fetch from the network and record every response to recordingPath
+    CT_NETWORK_REPLAY, // answer only from the recording at recordingPath, without network access
+};
+typedef enum CesiumNetworkMode CesiumNetworkMode;
+
+// Which entries a cache prune removes first once the cache is over budget. Expired entries are always removed.
+enum CesiumCachePolicy {
+    CT_CACHE_LRU, // the least recently used entries
+    CT_CACHE_EXPIRY_FIRST, // the entries closest to expiring
+};
+typedef enum CesiumCachePolicy CesiumCachePolicy;
+
+// Options controlling how tile requests are sent over the network.
+struct CesiumNetworkOptions {
+    bool shareConnectionCache; // share TLS sessions between all requests (connections and DNS are always shared)
+    uint32_t maxIdleHandles; // number of finished request handles kept for reuse (0 disables reuse)
+    CesiumHttpVersion httpVersion;
+    uint32_t maxConcurrentStreams; // HTTP/2 streams multiplexed over a single connection
+    uint32_t maxConnectionsPerHost; // 0 means unlimited
+    CesiumNetworkMode mode;
+    const char* recordingPath; // recording file for CT_NETWORK_RECORD and CT_NETWORK_REPLAY; if it cannot be opened, the network is used without recording
+    bool simulateRecordedLatency; // in CT_NETWORK_REPLAY, deliver each response after its recorded latency
+    uint64_t memoryCacheBytes; // size of the in-memory tier in front of the SQLite cache (0 disables it)
+    uint64_t cacheMaxItems; // entries kept in the SQLite cache by a prune (0 means unlimited); decoded models count too
+    uint64_t cacheMaxBytes; // response bytes kept in the SQLite cache by a prune (0 means unlimited)
+    CesiumCachePolicy cachePolicy;
+    uint32_t cachePruneInterval; // the cache is pruned after this many requests (0 prunes only on CesiumTileset_pruneCache)
+    uint32_t negativeCacheTtlSeconds; // how long 404 and 410 responses are remembered (0 disables negative caching)
+    uint32_t negativeCacheMaxEntries; // number of missing URLs remembered
+    // The HTTP client. With CT_HTTP_BACKEND_HTTPLIB, the connection sharing, HTTP version, stream
+    // and handle options above do not apply, no connection or timing statistics are collected,
+    // and stale tile loads are not cancelled.
+    CesiumHttpBackend httpBackend;
+};
+typedef struct CesiumNetworkOptions CesiumNetworkOptions;
+
+// Connection reuse counters for all requests issued since initialization.
+// The connection reuse rate is reusedConnections / requests.
+struct CesiumConnectionStats {
+    uint64_t requests;
+    uint64_t newConnections;
+    uint64_t reusedConnections;
+    uint64_t reusedHandles; // request handles reused from the idle pool; unrelated to connection reuse
+    uint64_t cancelledRequests;
+    uint64_t bytesSavedByCancellation;
+    uint64_t revalidations; // conditional requests sent for stale cache entries
+    uint64_t notModifiedResponses; // revalidations answered with 304 Not Modified
+    uint64_t bytesSavedByRevalidation; // cached body bytes that did not have to be downloaded again
+};
+typedef struct CesiumConnectionStats CesiumConnectionStats;
+
+#define CESIUM_NETWORK_HISTOGRAM_BUCKETS 32
+
+// A histogram with power-of-two buckets: buckets[0] counts zeros, buckets[i] counts values in [2^(i-1), 2^i).
+// The last bucket also counts all larger values.
+struct CesiumNetworkHistogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[CESIUM_NETWORK_HISTOGRAM_BUCKETS];
+};
+typedef struct CesiumNetworkHistogram CesiumNetworkHistogram;
+
+// Per-request timing breakdown of network requests. Times are in microseconds.
+// DNS, connect and TLS times are only recorded for requests that opened a new connection.
+struct CesiumNetworkStats {
+    CesiumNetworkHistogram dnsTime;
+    CesiumNetworkHistogram connectTime;
+    CesiumNetworkHistogram tlsTime;
+    CesiumNetworkHistogram timeToFirstByte;
+    CesiumNetworkHistogram totalTime;
+    CesiumNetworkHistogram responseBytes;
+    uint64_t http1Requests;
+    uint64_t http2Requests;
+    uint64_t http3Requests;
+    // Time spent decoding compressed responses on worker threads.
+    CesiumNetworkHistogram decodeTime;
+    // Responses received with each Content-Encoding (deflate is counted as gzip).
+    uint64_t gzipResponses;
+    uint64_t brotliResponses;
+    uint64_t zstdResponses;
+    // Size of compressed responses before and after decoding.
+    uint64_t compressedBytes;
+    uint64_t decodedBytes;
+};
+typedef struct CesiumNetworkStats CesiumNetworkStats;
+
+// Retry and hedging counters for a single tileset.
+struct CesiumTilesetRequestStats {
+    uint64_t requests;
+    uint64_t retries;
+    uint64_t hedges;
+    uint64_t hedgeWins;
+    uint64_t failures;
+};
+typedef struct CesiumTilesetRequestStats CesiumTilesetRequestStats;
+
+// A region to pre-load into the tile cache with CesiumTileset_seedRegion. Angles are in degrees,
+// heights in meters above the WGS84 ellipsoid. A region with east < west crosses the antimeridian.
+struct CesiumSeedOptions {
+    double west;
+    double south;
+    double east;
+    double north;
+    double minHeight;
+    double maxHeight;
+    double maximumScreenSpaceError; // tiles are loaded as if viewed at this screen-space error
+    uint32_t viewpointsPerAxis; // the region is covered by viewpointsPerAxis^2 synthetic nadir views
+    uint32_t maxConcurrentRequests; // upper bound on tiles loaded at the same time
+    const char* statePath; // file recording progress, so seeding resumes after an interruption (NULL disables this)
+};
+typedef struct CesiumSeedOptions CesiumSeedOptions;
+
+// Tile cache counters. Hit and miss counters, prune counters and histograms cover the time since
+// initialization or the last reset; entries and bytes are current values.
+struct CesiumCacheStats {
+    uint64_t memoryHits; // lookups answered by the in-memory tier
+    uint64_t memoryMisses;
+    uint64_t memoryEvictions;
+    uint64_t memoryEntries;
+    uint64_t memoryBytes;
+    uint64_t hits; // lookups answered by the SQLite cache, including its write queue
+    uint64_t misses;
+    uint64_t entries;
+    uint64_t bytes; // total size of the stored response bodies
+    uint64_t pendingEntries; // entries not yet written to disk
+    uint64_t prunes;
+    uint64_t prunedEntries;
+    CesiumNetworkHistogram lookupTime; // SQLite cache lookups, in microseconds
+    CesiumNetworkHistogram pruneTime; // in microseconds
+    CesiumNetworkHistogram commitTime; // batched writes, in microseconds
+    uint64_t decodedModelHits; // tile models loaded without decoding (see cacheDecodedModels)
+    uint64_t decodedModelStores;
+    uint64_t negativeHits; // requests answered with a remembered 404 or 410
+    uint64_t negativeEntries;
+};
+typedef struct CesiumCacheStats CesiumCacheStats;
+
+enum CesiumSeedState {
+    CT_SEED_RUNNING,
+    CT_SEED_DONE,
+    CT_SEED_CANCELLED,
+    CT_SEED_FAILED,
+};
+typedef enum CesiumSeedState CesiumSeedState;
+
+struct CesiumSeedProgress {
+    CesiumSeedState state;
+    uint32_t completedViewpoints;
+    uint32_t totalViewpoints;
+    uint64_t requests; // responses received, including ones answered from the cache
+    uint64_t bytes;
+};
+typedef struct CesiumSeedProgress CesiumSeedProgress;
+
+typedef struct CesiumSeed CesiumSeed;
+
 // Initializes all bindings. Must be called before any other CesiumTileset_ function.
-// numThreads refers to the number of threads that will be created for the Async system (job queue).
+// numThreads is the number of worker threads for CPU-bound work such as decoding tile content
+// (glTF, Draco, KTX2) and serializing models; 0 uses one per core minus one for the UI thread.
+// numIoThreads is the number of worker threads for blocking I/O: tile cache reads and writes,
+// local files and archives. Network transfers run on libcurl's own thread either way.
+// cacheDbPath is the SQLite tile cache file, or NULL to disable caching. If it names a directory
+// (an existing one, or any path ending in a separator), tile bodies are stored there as individual
+// files and the database in it only holds their metadata.
+// networkOptions configures connection sharing for all tile requests.
 //
-API_EXPORT void CesiumTileset_initialize(uint32_t numThreads, const char* cacheDbPath);
+API_EXPORT void CesiumTileset_initialize(uint32_t numThreads, uint32_t numIoThreads, const char* cacheDbPath, CesiumNetworkOptions networkOptions);
+
+// Returns the connection reuse counters of the network accessor.
+API_EXPORT CesiumConnectionStats CesiumTileset_getConnectionStats();
+
+// Returns timing histograms for all network requests. If reset is true, the histograms are cleared,
+// so the next call covers a new measurement window.
+API_EXPORT CesiumNetworkStats CesiumTileset_getNetworkStats(bool reset);
+
+// Limits the combined download rate of all tile requests. A value of 0 means unlimited.
+// Cache hits are not throttled. May be called at any time after CesiumTileset_initialize.
+// With the libcurl backend every transfer is also paced; with httplib the byte rate is only
+// enforced on average, a single large response still arrives at line rate.
+API_EXPORT void CesiumTileset_setGlobalRateLimit(double bytesPerSecond, double requestsPerSecond);
+
+// Limits the download rate of tile requests to a single host (e.g. "tile.googleapis.com").
+// Pass NULL as host to set the limits for every host without host-specific limits.
+// A value of 0 means unlimited.
+API_EXPORT void CesiumTileset_setHostRateLimit(const char* host, double bytesPerSecond, double requestsPerSecond);
 
 API_EXPORT void CesiumTileset_pumpAsyncQueue();
 
@@ -186,9 +391,53 @@ API_EXPORT int CesiumTileset_hasLoadError(CesiumTileset* tileset);
 // Retrieve the error message encountered when loading this tileset. Returns NULL if none.
 API_EXPORT void CesiumTileset_getErrorMessage(CesiumTileset* tileset, char* out);
 
+// Returns the number of requests, retries and hedged requests made for this tileset since it was created.
+API_EXPORT CesiumTilesetRequestStats CesiumTileset_getRequestStats(CesiumTileset* tileset);
+
 // Destroy a Tileset. This is an asynchronous operation; pass a callback as onTileDestroyEvent to be notified when destruction is complete.
 API_EXPORT void CesiumTileset_destroy(CesiumTileset* tileset, void(*onTileDestroyEvent)());
 
+// Writes all tile cache entries that are still queued to disk. Call this before the app may be
+// suspended or killed; CesiumTileset_destroy also does this.
+API_EXPORT void CesiumTileset_flushCache();
+
+// Returns the tile cache counters. If reset is true, the counters and histograms are cleared so that
+// the next call covers a new measurement window (in-memory tier and decoded model counters are not reset).
+API_EXPORT CesiumCacheStats CesiumTileset_getCacheStats(bool reset);
+
+// Changes the tile cache budget and prunes down to it in the background. maxItems and maxBytes
+// apply to the SQLite cache (0 means unlimited); memoryBytes resizes the in-memory tier, which can
+// not be enabled here if it was disabled at initialization.
+API_EXPORT void CesiumTileset_setCacheLimits(uint64_t maxItems, uint64_t maxBytes, uint64_t memoryBytes);
+
+// Changes which entries are removed first by later prunes.
+API_EXPORT void CesiumTileset_setCachePolicy(CesiumCachePolicy policy);
+
+// Removes expired entries and prunes the tile cache down to its budget in the background.
+API_EXPORT void CesiumTileset_pruneCache();
+
+// Removes every entry from the tile cache in the background, and forgets remembered 404 and 410 responses.
+API_EXPORT void CesiumTileset_clearCache();
+
+// Starts loading every tile needed to view a region into the tile cache, so it can later be viewed
+// offline. Requires a cache (see CesiumTileset_initialize). The tiles are pinned: pruning neither
+// expires nor evicts them, they do not count against the cache budget, and once expired they are
+// still served when refetching them fails. Only CesiumTileset_clearCache removes them.
+// Seeding runs on a background thread; callback is invoked from that thread after each viewpoint
+// and once more with a final state.
+// Returns NULL without a cache, or if north < south or minHeight > maxHeight.
+API_EXPORT CesiumSeed* CesiumTileset_seedRegion(const char* url, CesiumSeedOptions options, void(*callback)(CesiumSeedProgress));
+
+// As CesiumTileset_seedRegion, for a Cesium ion asset.
+API_EXPORT CesiumSeed* CesiumTileset_seedRegionFromIonAsset(int64_t assetId, const char* accessToken, CesiumSeedOptions options, void(*callback)(CesiumSeedProgress));
+
+// Stops seeding after the viewpoint currently being loaded. Progress is kept in statePath.
+API_EXPORT void CesiumTileset_cancelSeed(CesiumSeed* seed);
+
+// Cancels seeding if it is still running and frees seed without waiting for it to stop; callback
+// is not invoked once this returns.
+API_EXPORT void CesiumTileset_destroySeed(CesiumSeed* seed);
+
 // Update the view and get the number of tiles to render
 API_EXPORT int CesiumTileset_updateView(CesiumTileset* tileset, const CesiumViewState viewState, float deltaTime);
 
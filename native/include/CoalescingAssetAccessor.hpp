@@ -0,0 +1,146 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumAsync/Promise.h>
+#include <CesiumAsync/SharedFuture.h>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// An IAssetAccessor decorator that collapses concurrent identical GET and HEAD requests into a
+// single request to the wrapped accessor. Requests are identified by method, URL and authorization
+// headers, so a GET and a HEAD for the same URL are never merged; every caller that asks for the
+// same key while the first request is still in flight receives a Future that shares its result (or
+// its error). Other methods and requests with a payload are passed through.
+class CoalescingAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    CoalescingAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor)
+        : _pAssetAccessor(pAssetAccessor) {}
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        // requests with a body or side effects are never shared
+        if ((verb != "GET" && verb != "HEAD") || !contentPayload.empty()) {
+            return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        }
+
+        std::string key = createKey(verb, url, headers);
+        uint64_t id = 0;
+        std::optional<CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>>> promise;
+        std::optional<CesiumAsync::SharedFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>> inFlight;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _inFlight.find(key);
+            if (it != _inFlight.end()) {
+                _coalescedRequests++;
+                inFlight = it->second.future;
+            } else {
+                // Publish a placeholder that later callers can join; the request itself is sent
+                // outside the lock, so the layers below are not serialized behind it and may
+                // complete inline.
+                id = ++_nextId;
+                promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+                inFlight = promise->getFuture().share();
+                it = _inFlight.emplace(key, InFlightRequest { id, url, 0, *inFlight }).first;
+            }
+            it->second.waiters++;
+            _waitersByUrl[url]++;
+        }
+
+        if (promise) {
+            // The entry is dropped before the result is published, whether it succeeded or failed,
+            // so a caller arriving afterwards sends a fresh request.
+            try {
+                _pAssetAccessor->request(asyncSystem, verb, url, headers)
+                    .thenImmediately([this, key, id, promise = *promise](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                        finish(key, id);
+                        promise.resolve(std::move(pRequest));
+                    })
+                    .catchImmediately([this, key, id, promise = *promise](std::exception&&) {
+                        finish(key, id);
+                        promise.reject(std::current_exception());
+                    });
+            } catch (...) {
+                finish(key, id);
+                promise->reject(std::current_exception());
+            }
+        }
+
+        return inFlight->thenImmediately([](const std::shared_ptr<CesiumAsync::IAssetRequest>& pRequest) {
+            return pRequest;
+        });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+    // The number of requests that were answered by an identical request already in flight.
+    uint64_t getCoalescedRequestCount() const {
+        return _coalescedRequests;
+    }
+
+    // The number of callers currently waiting for a shared request of url. A request with more
+    // than one waiter must not be cancelled on behalf of only one of them.
+    size_t getWaiterCount(const std::string& url) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _waitersByUrl.find(url);
+        return it == _waitersByUrl.end() ? 0 : it->second;
+    }
+
+private:
+    struct InFlightRequest {
+        uint64_t id;
+        std::string url;
+        size_t waiters;
+        CesiumAsync::SharedFuture<std::shared_ptr<CesiumAsync::IAssetRequest>> future;
+    };
+
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, InFlightRequest> _inFlight;
+    std::unordered_map<std::string, size_t> _waitersByUrl;
+    uint64_t _nextId = 0;
+    std::atomic<uint64_t> _coalescedRequests { 0 };
+
+    void finish(const std::string& key, uint64_t id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _inFlight.find(key);
+        if (it != _inFlight.end() && it->second.id == id) {
+            auto waiters = _waitersByUrl.find(it->second.url);
+            if (waiters != _waitersByUrl.end() && (waiters->second -= it->second.waiters) == 0) {
+                _waitersByUrl.erase(waiters);
+            }
+            _inFlight.erase(it);
+        }
+    }
+
+    static std::string createKey(const std::string& verb, const std::string& url, const std::vector<THeader>& headers) {
+        std::string key = verb + " " + url;
+        for (const auto& header : headers) {
+            if (header.first == "Authorization" || header.first == "authorization") {
+                key += "\n" + header.second;
+            }
+        }
+        return key;
+    }
+};
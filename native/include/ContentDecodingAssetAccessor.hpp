@@ -0,0 +1,262 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include <zstd.h>
+
+#if __has_include(<brotli/decode.h>)
+#include <brotli/decode.h>
+#define CESIUM_HAS_BROTLI 1
+#else
+#define CESIUM_HAS_BROTLI 0
+#endif
+
+#include "FileAssetAccessor.hpp"
+#include "NetworkTimingStats.hpp"
+
+// Compression counters of ContentDecodingAssetAccessor. Byte counts only include encoded responses,
+// so compressedBytes / decodedBytes is the compression ratio of what was actually compressed.
+struct ContentDecodingStats {
+    std::atomic<uint64_t> gzipResponses { 0 };
+    std::atomic<uint64_t> brotliResponses { 0 };
+    std::atomic<uint64_t> zstdResponses { 0 };
+    std::atomic<uint64_t> compressedBytes { 0 };
+    std::atomic<uint64_t> decodedBytes { 0 };
+    // Time spent decoding a single response, in microseconds.
+    Histogram decodeTime;
+};
+
+// An IAssetAccessor decorator that negotiates Content-Encoding itself instead of leaving it to
+// libcurl, which would decode on its single I/O thread and only knows the encodings it was built
+// with. Requests advertise zstd, gzip and deflate, and brotli only if <brotli/decode.h> is found
+// at build time (it is not vendored, and the build links no brotli library, so by default br is
+// compiled out). Encoded responses are decoded on a worker thread and handed on without the
+// Content-Encoding header, so caches store the decoded body.
+//
+// The wrapped accessor must not decode responses itself.
+class ContentDecodingAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    ContentDecodingAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor)
+        : _pAssetAccessor(pAssetAccessor) {}
+
+    ContentDecodingStats& getStats() {
+        return _stats;
+    }
+
+    static const char* getAcceptEncoding() {
+#if CESIUM_HAS_BROTLI
+        return "zstd, br, gzip, deflate";
+#else
+        return "zstd, gzip, deflate";
+#endif
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        std::vector<THeader> requestHeaders = headers;
+        bool hasAcceptEncoding = std::any_of(headers.begin(), headers.end(), [](const THeader& header) {
+            return equalsIgnoreCase(header.first, "Accept-Encoding");
+        });
+        if (!hasAcceptEncoding) {
+            requestHeaders.emplace_back("Accept-Encoding", getAcceptEncoding());
+        }
+
+        return _pAssetAccessor->request(asyncSystem, verb, url, requestHeaders, contentPayload)
+            .thenInWorkerThread([this](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                return decode(std::move(pRequest));
+            });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    ContentDecodingStats _stats;
+
+    std::shared_ptr<CesiumAsync::IAssetRequest> decode(std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+        const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+        if (!pResponse) {
+            return std::move(pRequest);
+        }
+        auto contentEncoding = pResponse->headers().find("Content-Encoding");
+        if (contentEncoding == pResponse->headers().end()) {
+            return std::move(pRequest);
+        }
+        std::string encoding = contentEncoding->second;
+        std::transform(encoding.begin(), encoding.end(), encoding.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        if (encoding == "identity" || pResponse->data().empty()) {
+            return std::move(pRequest);
+        }
+
+        gsl::span<const std::byte> data = pResponse->data();
+        auto start = std::chrono::steady_clock::now();
+        auto pBody = std::make_shared<std::vector<std::byte>>();
+        if (encoding == "zstd") {
+            decodeZstd(data, *pBody);
+            _stats.zstdResponses++;
+        } else if (encoding == "gzip" || encoding == "x-gzip" || encoding == "deflate") {
+            decodeZlib(data, *pBody);
+            _stats.gzipResponses++;
+#if CESIUM_HAS_BROTLI
+        } else if (encoding == "br") {
+            decodeBrotli(data, *pBody);
+            _stats.brotliResponses++;
+#endif
+        } else {
+            throw std::runtime_error("Unsupported Content-Encoding " + contentEncoding->second + " for " + pRequest->url());
+        }
+        _stats.decodeTime.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+        _stats.compressedBytes += data.size();
+        _stats.decodedBytes += pBody->size();
+
+        CesiumAsync::HttpHeaders responseHeaders = pResponse->headers();
+        responseHeaders.erase("Content-Encoding");
+        responseHeaders.erase("Content-Length");
+        gsl::span<const std::byte> body(pBody->data(), pBody->size());
+        return std::make_shared<FileAssetRequest>(
+            pRequest->method(),
+            pRequest->url(),
+            pRequest->headers(),
+            std::make_unique<FileAssetResponse>(
+                pResponse->statusCode(),
+                pResponse->contentType(),
+                body,
+                std::move(pBody),
+                std::move(responseHeaders)));
+    }
+
+    // Largest decoded size allocated in one piece from a zstd frame header.
+    static constexpr unsigned long long kMaxPresizedZstdBytes = 64 * 1024 * 1024;
+    // Largest decoded body accepted from any encoding, 64 times the largest buffer the response pool
+    // keeps. A few kilobytes of compressed input can expand to gigabytes, so the streaming decoders
+    // give up here instead of growing the output until allocation fails.
+    static constexpr size_t kMaxDecodedBytes = 256 * 1024 * 1024;
+
+    // Grows output by up to chunk bytes for the next decode step and returns its previous size.
+    static size_t growDecoded(std::vector<std::byte>& output, size_t chunk) {
+        size_t written = output.size();
+        if (written >= kMaxDecodedBytes) {
+            throw std::runtime_error("Decoded response exceeds " + std::to_string(kMaxDecodedBytes) + " bytes");
+        }
+        output.resize(written + std::min(chunk, kMaxDecodedBytes - written));
+        return written;
+    }
+
+    static void decodeZstd(gsl::span<const std::byte> data, std::vector<std::byte>& output) {
+        // The frame header is untrusted: its size is only used to allocate up front if the body is a
+        // single frame and the size is plausible. Everything else takes the streaming path, which
+        // grows the output as data is actually decoded.
+        unsigned long long contentSize = ZSTD_getFrameContentSize(data.data(), data.size());
+        bool singleFrame = ZSTD_findFrameCompressedSize(data.data(), data.size()) == data.size();
+        if (singleFrame && contentSize != ZSTD_CONTENTSIZE_UNKNOWN && contentSize != ZSTD_CONTENTSIZE_ERROR &&
+            contentSize <= kMaxPresizedZstdBytes) {
+            output.resize(static_cast<size_t>(contentSize));
+            size_t result = ZSTD_decompress(output.data(), output.size(), data.data(), data.size());
+            if (ZSTD_isError(result)) {
+                throw std::runtime_error(std::string("Failed to decode zstd response: ") + ZSTD_getErrorName(result));
+            }
+            output.resize(result);
+            return;
+        }
+
+        std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)> pStream(ZSTD_createDStream(), ZSTD_freeDStream);
+        ZSTD_inBuffer input { data.data(), data.size(), 0 };
+        size_t result = 1;
+        while (input.pos < input.size || result != 0) {
+            size_t written = growDecoded(output, std::max(ZSTD_DStreamOutSize(), data.size()));
+            ZSTD_outBuffer out { output.data() + written, output.size() - written, 0 };
+            result = ZSTD_decompressStream(pStream.get(), &out, &input);
+            output.resize(written + out.pos);
+            if (ZSTD_isError(result)) {
+                throw std::runtime_error(std::string("Failed to decode zstd response: ") + ZSTD_getErrorName(result));
+            }
+            if (input.pos == input.size && out.pos == 0 && result != 0) {
+                throw std::runtime_error("Truncated zstd response");
+            }
+        }
+    }
+
+    static void decodeZlib(gsl::span<const std::byte> data, std::vector<std::byte>& output) {
+        // 15 + 32 detects gzip and zlib headers; some servers send "deflate" as a raw stream instead
+        if (!inflateAll(data, 15 + 32, output) && !inflateAll(data, -15, output)) {
+            throw std::runtime_error("Failed to decode gzip/deflate response");
+        }
+    }
+
+    static bool inflateAll(gsl::span<const std::byte> data, int windowBits, std::vector<std::byte>& output) {
+        z_stream stream {};
+        if (inflateInit2(&stream, windowBits) != Z_OK) {
+            return false;
+        }
+        std::unique_ptr<z_stream, decltype(&inflateEnd)> pStream(&stream, inflateEnd);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        output.clear();
+        int result = Z_OK;
+        while (result == Z_OK) {
+            size_t written = growDecoded(output, std::max<size_t>(data.size() * 4, 16384));
+            stream.next_out = reinterpret_cast<Bytef*>(output.data() + written);
+            stream.avail_out = static_cast<uInt>(output.size() - written);
+            result = inflate(&stream, Z_NO_FLUSH);
+            output.resize(output.size() - stream.avail_out);
+            if (result == Z_BUF_ERROR && stream.avail_in == 0) {
+                break;
+            }
+        }
+        return result == Z_STREAM_END;
+    }
+
+#if CESIUM_HAS_BROTLI
+    static void decodeBrotli(gsl::span<const std::byte> data, std::vector<std::byte>& output) {
+        std::unique_ptr<BrotliDecoderState, decltype(&BrotliDecoderDestroyInstance)> pState(
+            BrotliDecoderCreateInstance(nullptr, nullptr, nullptr), BrotliDecoderDestroyInstance);
+        size_t availableIn = data.size();
+        const uint8_t* nextIn = reinterpret_cast<const uint8_t*>(data.data());
+        BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+        while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+            size_t written = growDecoded(output, std::max<size_t>(data.size() * 4, 16384));
+            size_t availableOut = output.size() - written;
+            uint8_t* nextOut = reinterpret_cast<uint8_t*>(output.data() + written);
+            result = BrotliDecoderDecompressStream(pState.get(), &availableIn, &nextIn, &availableOut, &nextOut, nullptr);
+            output.resize(output.size() - availableOut);
+        }
+        if (result != BROTLI_DECODER_RESULT_SUCCESS) {
+            throw std::runtime_error("Failed to decode brotli response");
+        }
+    }
+#endif
+
+    static bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+};
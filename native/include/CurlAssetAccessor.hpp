@@ -10,19 +10,35 @@
 #include <sstream>
 #include <zlib.h>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <functional>
+
+#include "RequestCancelledError.hpp"
+#include "ResponseBufferPool.hpp"
+#include "NetworkTimingStats.hpp"
 
 using namespace Cesium3DTilesSelection;
 
 class CurlAssetResponse : public CesiumAsync::IAssetResponse {
 public:
-    CurlAssetResponse(long statusCode, const std::string& contentType, const std::vector<uint8_t>& data, const CesiumAsync::HttpHeaders& headers)
-        : _statusCode(statusCode), _contentType(contentType), _data(data), _headers(headers) {
+    CurlAssetResponse(long statusCode, const std::string& contentType, std::vector<uint8_t>&& data, CesiumAsync::HttpHeaders&& headers, std::weak_ptr<ResponseBufferPool> bufferPool = {})
+        : _statusCode(statusCode), _contentType(contentType), _data(std::move(data)), _headers(std::move(headers)), _bufferPool(std::move(bufferPool)) {
         // spdlog::debug("CurlAssetResponse headers:");
         // for (const auto& [key, value] : _headers) {
         //     spdlog::debug("  {}: {}", key, value);
         // }
     }
 
+    ~CurlAssetResponse() {
+        // hand the body allocation back so the next download can reuse it
+        if (auto pool = _bufferPool.lock()) {
+            pool->release(std::move(_data));
+        }
+    }
+
     virtual uint16_t statusCode() const override { return static_cast<uint16_t>(_statusCode); }
     virtual const CesiumAsync::HttpHeaders& headers() const override { return _headers; }
     virtual gsl::span<const std::byte> data() const override {
@@ -37,6 +53,7 @@ private:
     std::string _contentType;
     std::vector<uint8_t> _data;
     CesiumAsync::HttpHeaders _headers;
+    std::weak_ptr<ResponseBufferPool> _bufferPool;
 };
 
 class CurlAssetRequest : public CesiumAsync::IAssetRequest {
@@ -60,13 +77,108 @@ private:
     std::unique_ptr<CurlAssetResponse> _response;
 };
 
+// A single in-flight transfer. Created on the calling thread, then owned by the
+// accessor's I/O thread until its promise has been resolved or rejected.
+struct CurlTransfer {
+    CurlTransfer(
+        const CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>>& promise_,
+        std::shared_ptr<CurlAssetRequest> request_,
+        ResponseBufferPool* bufferPool_)
+        : promise(promise_), request(std::move(request_)), bufferPool(bufferPool_) {}
+
+    ~CurlTransfer() {
+        if (curl) {
+            curl_easy_cleanup(curl);
+        }
+        curl_slist_free_all(requestHeaders);
+    }
+
+    CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>> promise;
+    std::shared_ptr<CurlAssetRequest> request;
+    ResponseBufferPool* bufferPool;
+    CURL* curl = nullptr;
+    struct curl_slist* requestHeaders = nullptr;
+    std::vector<std::byte> payload;
+    std::vector<uint8_t> responseData;
+    CesiumAsync::HttpHeaders responseHeaders;
+};
+
+// Connection management options for CurlAssetAccessor.
+struct CurlAssetAccessorOptions {
+    // Share the TLS session cache between all requests. Connections and the DNS cache belong to the
+    // multi handle, which every transfer runs on, so they are always shared.
+    bool shareConnectionCache = true;
+    // Maximum number of finished easy handles kept around for reuse (0 disables reuse).
+    size_t maxIdleHandles = 32;
+    // HTTP version to negotiate (one of CURL_HTTP_VERSION_*). CURL_HTTP_VERSION_2TLS uses
+    // HTTP/2 for https:// and HTTP/1.1 for http://; CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE
+    // forces HTTP/2 over cleartext (h2c).
+    long httpVersion = CURL_HTTP_VERSION_2TLS;
+    // Maximum number of concurrent HTTP/2 streams multiplexed over a single connection.
+    long maxConcurrentStreams = 100;
+    // Maximum number of connections opened to a single host (0 means unlimited).
+    long maxConnectionsPerHost = 0;
+};
+
+// Counters describing how often connections and easy handles were reused.
+struct CurlAssetAccessorStats {
+    uint64_t requests = 0;
+    uint64_t newConnections = 0;
+    uint64_t reusedConnections = 0;
+    // Easy handles taken from the idle pool instead of allocated. Says nothing about connection
+    // reuse; connections are kept by the multi handle whichever easy handle runs a transfer.
+    uint64_t reusedHandles = 0;
+    uint64_t cancelledRequests = 0;
+    // Bytes that did not need to be downloaded because their request was cancelled.
+    // Only counted for responses that announced their Content-Length.
+    uint64_t bytesSavedByCancellation = 0;
+};
+
+// Performs all HTTP transfers on a single dedicated I/O thread using a curl multi handle.
+// request() only builds the easy handle and queues it; the I/O thread drives every
+// transfer concurrently and resolves the returned Future when the transfer completes,
+// so worker threads in the AsyncSystem are never blocked waiting on the network.
 class CurlAssetAccessor : public CesiumAsync::IAssetAccessor {
 public:
-    CurlAssetAccessor(const std::string& authToken = "") : _authToken(authToken) {
+    CurlAssetAccessor(const CurlAssetAccessorOptions& options = CurlAssetAccessorOptions(), const std::string& authToken = "")
+        : _options(options), _authToken(authToken) {
         curl_global_init(CURL_GLOBAL_DEFAULT);
+        _multi = curl_multi_init();
+        if (!_multi) {
+            throw std::runtime_error("Failed to initialize CURL multi handle");
+        }
+        if (_options.httpVersion >= CURL_HTTP_VERSION_2_0) {
+            // Let a burst of tile requests share one connection instead of opening one each.
+            curl_multi_setopt(_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+            curl_multi_setopt(_multi, CURLMOPT_MAX_CONCURRENT_STREAMS, _options.maxConcurrentStreams);
+        }
+        if (_options.maxConnectionsPerHost > 0) {
+            curl_multi_setopt(_multi, CURLMOPT_MAX_HOST_CONNECTIONS, _options.maxConnectionsPerHost);
+        }
+        if (_options.shareConnectionCache) {
+            _share = curl_share_init();
+            curl_share_setopt(_share, CURLSHOPT_LOCKFUNC, LockCallback);
+            curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC, UnlockCallback);
+            curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+        _running = true;
+        _ioThread = std::thread(&CurlAssetAccessor::processTransfers, this);
     }
 
     ~CurlAssetAccessor() {
+        _running = false;
+        curl_multi_wakeup(_multi);
+        if (_ioThread.joinable()) {
+            _ioThread.join();
+        }
+        for (CURL* curl : _idleHandles) {
+            curl_easy_cleanup(curl);
+        }
+        curl_multi_cleanup(_multi);
+        if (_share) {
+            curl_share_cleanup(_share);
+        }
         curl_global_cleanup();
     }
 
@@ -74,6 +186,43 @@ public:
         _authToken = authToken;
     }
 
+    CurlAssetAccessorStats getStats() const {
+        CurlAssetAccessorStats stats;
+        stats.requests = _requests;
+        stats.newConnections = _newConnections;
+        stats.reusedConnections = _reusedConnections;
+        stats.reusedHandles = _reusedHandles;
+        stats.cancelledRequests = _cancelledRequests;
+        stats.bytesSavedByCancellation = _bytesSavedByCancellation;
+        return stats;
+    }
+
+    // Timing histograms of completed transfers. Snapshot them with Histogram::snapshot().
+    NetworkTimingStats& getTimingStats() {
+        return _timingStats;
+    }
+
+    // Cancels every queued or in-flight request whose URL matches the predicate. The
+    // predicate is evaluated on the I/O thread. Cancelled transfers are removed from the
+    // multi handle and their Futures are rejected, so the requesting tile fails
+    // temporarily and is requested again if it is needed later.
+    void cancelRequests(std::function<bool(const std::string& url)> predicate) {
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _cancellations.push_back(std::move(predicate));
+        }
+        curl_multi_wakeup(_multi);
+    }
+
+    // Caps the receive rate of each transfer at the bytes per second returned for its URL (0 for
+    // no cap), e.g. ThrottlingAssetAccessor::getTransferByteRate. Called on the requesting thread
+    // when the transfer is set up, and again on the I/O thread for every active transfer whenever a
+    // transfer starts or finishes, so a rate split between transfers follows their number. Must be
+    // set before the first request.
+    void setReceiveRateLimit(std::function<double(const std::string& url)> limit) {
+        _receiveRateLimit = std::move(limit);
+    }
+
     CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
         const CesiumAsync::AsyncSystem& asyncSystem,
         const std::string& url,
@@ -87,144 +236,430 @@ public:
         const std::string& url,
         const std::vector<THeader>& headers,
         const gsl::span<const std::byte>& contentPayload = {}) override {
-       
-        return asyncSystem.runInWorkerThread([this, verb, url, headers, contentPayload]() {
-            // spdlog::debug("Starting {} request to: {}", verb, url);
-            
-            auto request = std::make_shared<CurlAssetRequest>(verb, url, CesiumAsync::HttpHeaders(headers.begin(), headers.end()));
-            
-            CURL* curl = curl_easy_init();
-            if (!curl) {
-                throw std::runtime_error("Failed to initialize CURL");
+
+        auto promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+        auto future = promise.getFuture();
+
+        auto transfer = std::make_unique<CurlTransfer>(
+            promise,
+            std::make_shared<CurlAssetRequest>(verb, url, CesiumAsync::HttpHeaders(headers.begin(), headers.end())),
+            _bufferPool.get());
+        // the payload span is only valid for the duration of this call
+        transfer->payload.assign(contentPayload.begin(), contentPayload.end());
+
+        transfer->curl = acquireHandle();
+        if (!transfer->curl) {
+            promise.reject(std::runtime_error("Failed to initialize CURL"));
+            return future;
+        }
+        setupTransfer(*transfer, verb, url, headers);
+
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _queuedTransfers.push_back(std::move(transfer));
+        }
+        curl_multi_wakeup(_multi);
+
+        return future;
+    }
+
+    void tick() noexcept override {}
+
+private:
+    CurlAssetAccessorOptions _options;
+    std::string _authToken;
+    std::function<double(const std::string&)> _receiveRateLimit;
+
+    CURLSH* _share = nullptr;
+    std::shared_ptr<ResponseBufferPool> _bufferPool = std::make_shared<ResponseBufferPool>();
+    std::mutex _shareMutexes[CURL_LOCK_DATA_LAST];
+
+    // Finished easy handles that have been reset and can be reused by the next request.
+    std::mutex _idleHandlesMutex;
+    std::vector<CURL*> _idleHandles;
+
+    std::atomic<uint64_t> _requests { 0 };
+    std::atomic<uint64_t> _newConnections { 0 };
+    std::atomic<uint64_t> _reusedConnections { 0 };
+    std::atomic<uint64_t> _reusedHandles { 0 };
+    std::atomic<uint64_t> _cancelledRequests { 0 };
+    std::atomic<uint64_t> _bytesSavedByCancellation { 0 };
+    NetworkTimingStats _timingStats;
+
+    CURLM* _multi = nullptr;
+    std::thread _ioThread;
+    std::atomic<bool> _running { false };
+
+    // Transfers created by request() but not yet added to the multi handle.
+    std::mutex _queueMutex;
+    std::vector<std::unique_ptr<CurlTransfer>> _queuedTransfers;
+    std::vector<std::function<bool(const std::string&)>> _cancellations;
+
+    // Transfers currently attached to the multi handle. Only touched by the I/O thread.
+    std::unordered_map<CURL*, std::unique_ptr<CurlTransfer>> _activeTransfers;
+
+    CURL* acquireHandle() {
+        {
+            std::lock_guard<std::mutex> lock(_idleHandlesMutex);
+            if (!_idleHandles.empty()) {
+                CURL* curl = _idleHandles.back();
+                _idleHandles.pop_back();
+                _reusedHandles++;
+                return curl;
             }
+        }
+        return curl_easy_init();
+    }
 
-            // Set up response headers collection before the request
-            CesiumAsync::HttpHeaders responseHeaders;
-            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
-            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &responseHeaders);
-            
-            // Basic CURL setup
-            curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 0L);
-            curl_easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 1L);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
-            #ifdef __ANDROID_API__
-            char *capath = NULL;
-            curl_easy_getinfo(curl, CURLINFO_CAPATH, capath);
-            curl_easy_setopt(curl, CURLOPT_CAPATH, "/etc/security/cacerts/");
-            #endif
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, verb.c_str());
-            curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
-
-            // Prepare request headers
-            struct curl_slist* chunk = nullptr;
-            
-            // Add cache control headers if not present in the original request
-            bool hasCacheControl = false;
-            for (const auto& header : headers) {
-                std::string headerStr = header.first + ": " + header.second;
-                chunk = curl_slist_append(chunk, headerStr.c_str());
-                spdlog::debug("Request header: {}", headerStr);
-                
-                if (header.first == "Cache-Control") {
-                    hasCacheControl = true;
+    // Returns a finished easy handle to the idle pool. curl_easy_reset clears all options but
+    // keeps the handle's own TLS session IDs. Its connections are not the handle's: under the
+    // multi interface they live in the multi handle's pool and are reused by any transfer.
+    void releaseHandle(CURL* curl) {
+        curl_easy_reset(curl);
+        {
+            std::lock_guard<std::mutex> lock(_idleHandlesMutex);
+            if (_idleHandles.size() < _options.maxIdleHandles) {
+                _idleHandles.push_back(curl);
+                return;
+            }
+        }
+        curl_easy_cleanup(curl);
+    }
+
+    void setupTransfer(CurlTransfer& transfer, const std::string& verb, const std::string& url, const std::vector<THeader>& headers) {
+        CURL* curl = transfer.curl;
+        if (_share) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, _share);
+        }
+
+        // Set up response headers collection before the request
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer);
+
+        // Basic CURL setup
+        curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+        #ifdef __ANDROID_API__
+        curl_easy_setopt(curl, CURLOPT_CAPATH, "/etc/security/cacerts/");
+        #endif
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, verb.c_str());
+        // bodies are passed on as received; ContentDecodingAssetAccessor decodes them on a worker thread
+        curl_easy_setopt(curl, CURLOPT_HTTP_CONTENT_DECODING, 0L);
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, _options.httpVersion);
+        if (_options.httpVersion >= CURL_HTTP_VERSION_2_0) {
+            // Wait for an in-progress connection to the same host so the request can be
+            // multiplexed over it, rather than opening a new connection.
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+        }
+        applyReceiveRateLimit(curl, url);
+
+        if (!transfer.payload.empty()) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer.payload.data());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(transfer.payload.size()));
+        }
+
+        // Prepare request headers
+        struct curl_slist* chunk = nullptr;
+        for (const auto& header : headers) {
+            std::string headerStr = header.first + ": " + header.second;
+            chunk = curl_slist_append(chunk, headerStr.c_str());
+            spdlog::debug("Request header: {}", headerStr);
+        }
+
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
+        transfer.requestHeaders = chunk;
+
+        // Set up response data collection
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
+    }
+
+    void applyReceiveRateLimit(CURL* curl, const std::string& url) {
+        if (_receiveRateLimit) {
+            // libcurl reads the limit on every speed check, so it can be changed during a transfer
+            double bytesPerSecond = _receiveRateLimit(url);
+            curl_easy_setopt(curl, CURLOPT_MAX_RECV_SPEED_LARGE,
+                static_cast<curl_off_t>(bytesPerSecond > 0 ? std::max(bytesPerSecond, 1.0) : 0.0));
+        }
+    }
+
+    // Runs on the I/O thread for the lifetime of the accessor.
+    void processTransfers() {
+        while (_running) {
+            std::vector<std::function<bool(const std::string&)>> cancellations;
+            size_t activeTransfers = _activeTransfers.size();
+            bool transfersChanged = false;
+            {
+                std::lock_guard<std::mutex> lock(_queueMutex);
+                transfersChanged = !_queuedTransfers.empty();
+                for (auto& transfer : _queuedTransfers) {
+                    CURL* curl = transfer->curl;
+                    curl_multi_add_handle(_multi, curl);
+                    _activeTransfers.emplace(curl, std::move(transfer));
                 }
+                _queuedTransfers.clear();
+                cancellations.swap(_cancellations);
             }
 
-            if (!hasCacheControl) {
-                // default is 1 hour
-                const char* cacheControl = "Cache-Control: max-age=3600";
-                chunk = curl_slist_append(chunk, cacheControl);
-                spdlog::debug("Added default {}", cacheControl);
+            for (const auto& predicate : cancellations) {
+                cancelMatchingTransfers(predicate);
             }
 
-            chunk = curl_slist_append(chunk, "Accept-Encoding: gzip, deflate");
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
+            int stillRunning = 0;
+            CURLMcode mc = curl_multi_perform(_multi, &stillRunning);
+            if (mc != CURLM_OK) {
+                spdlog::error("curl_multi_perform failed: {}", curl_multi_strerror(mc));
+            }
 
-            // Set up response data collection
-            std::vector<uint8_t> responseData;
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseData);
+            int messagesInQueue = 0;
+            while (CURLMsg* msg = curl_multi_info_read(_multi, &messagesInQueue)) {
+                if (msg->msg != CURLMSG_DONE) {
+                    continue;
+                }
+                CURL* curl = msg->easy_handle;
+                CURLcode result = msg->data.result;
+                curl_multi_remove_handle(_multi, curl);
+                auto it = _activeTransfers.find(curl);
+                if (it == _activeTransfers.end()) {
+                    continue;
+                }
+                std::unique_ptr<CurlTransfer> transfer = std::move(it->second);
+                _activeTransfers.erase(it);
+                completeTransfer(*transfer, result);
+                releaseHandle(transfer->curl);
+                transfer->curl = nullptr;
+                transfersChanged = true;
+            }
 
-            // Execute request
-            CURLcode res = curl_easy_perform(curl);
-            
-            if (res != CURLE_OK) {
-                spdlog::error("CURL request failed: {}", curl_easy_strerror(res));
-                curl_easy_cleanup(curl);
-                curl_slist_free_all(chunk);
-                throw std::runtime_error(curl_easy_strerror(res));
+            // A transfer started or finished: re-split the rate between the ones still running.
+            // Finished and cancelled transfers have already been counted out by the callback's
+            // owner, since their promises were settled inline above.
+            if (_receiveRateLimit && (transfersChanged || _activeTransfers.size() != activeTransfers)) {
+                for (auto& [curl, transfer] : _activeTransfers) {
+                    applyReceiveRateLimit(curl, transfer->request->url());
+                }
             }
 
-            // Get response info
-            long statusCode;
-            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &statusCode);
-
-            char* contentType;
-            curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &contentType);
-
-            // Add Expires header if not present in response
-            if (responseHeaders.find("Expires") == responseHeaders.end()) {
-                std::time_t now = std::time(nullptr);
-                // default is 1 hour like in the generated cache-control header
-                std::time_t expires = now + 3600;
-                char expiresStr[100];
-                std::strftime(expiresStr, sizeof(expiresStr), "%a, %d %b %Y %H:%M:%S GMT", std::gmtime(&expires));
-                responseHeaders["Expires"] = expiresStr;
-                // spdlog::debug("Added Expires header: {}", expiresStr);
+            curl_multi_poll(_multi, nullptr, 0, 1000, nullptr);
+        }
+
+        // Shutting down; fail anything that never completed so no Future is left dangling.
+        std::vector<std::unique_ptr<CurlTransfer>> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            abandoned = std::move(_queuedTransfers);
+        }
+        for (auto& [curl, transfer] : _activeTransfers) {
+            curl_multi_remove_handle(_multi, curl);
+            abandoned.push_back(std::move(transfer));
+        }
+        _activeTransfers.clear();
+        for (auto& transfer : abandoned) {
+            transfer->promise.reject(std::runtime_error("CurlAssetAccessor destroyed before request completed"));
+        }
+    }
+
+    void cancelMatchingTransfers(const std::function<bool(const std::string&)>& predicate) {
+        for (auto it = _activeTransfers.begin(); it != _activeTransfers.end();) {
+            CurlTransfer& transfer = *it->second;
+            if (!predicate(transfer.request->url())) {
+                ++it;
+                continue;
+            }
+
+            curl_off_t contentLength = -1;
+            curl_off_t downloaded = 0;
+            curl_easy_getinfo(transfer.curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+            curl_easy_getinfo(transfer.curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+            if (contentLength > downloaded) {
+                _bytesSavedByCancellation += static_cast<uint64_t>(contentLength - downloaded);
             }
+            _cancelledRequests++;
 
-            auto response = std::make_unique<CurlAssetResponse>(
-                statusCode,
-                contentType ? contentType : "",
-                responseData,
-                responseHeaders
-            );
-            request->setResponse(std::move(response));
+            spdlog::debug("Cancelled request: {}", transfer.request->url());
+            curl_multi_remove_handle(_multi, transfer.curl);
+            transfer.promise.reject(RequestCancelledError(transfer.request->url()));
+            _bufferPool->release(std::move(transfer.responseData));
+            releaseHandle(transfer.curl);
+            transfer.curl = nullptr;
+            it = _activeTransfers.erase(it);
+        }
+    }
 
-            curl_easy_cleanup(curl);
-            curl_slist_free_all(chunk);
+    void completeTransfer(CurlTransfer& transfer, CURLcode res) {
+        _requests++;
+        long numConnects = 0;
+        curl_easy_getinfo(transfer.curl, CURLINFO_NUM_CONNECTS, &numConnects);
+        if (numConnects > 0) {
+            _newConnections += numConnects;
+        } else {
+            _reusedConnections++;
+        }
 
-            // spdlog::debug("Request completed: {} {} (status: {})", verb, url, statusCode);
-            return (std::shared_ptr<CesiumAsync::IAssetRequest>)request;
-        });
+        if (res != CURLE_OK) {
+            spdlog::error("CURL request failed: {}", curl_easy_strerror(res));
+            transfer.promise.reject(std::runtime_error(curl_easy_strerror(res)));
+            _bufferPool->release(std::move(transfer.responseData));
+            return;
+        }
+
+        // Get response info
+        long statusCode;
+        curl_easy_getinfo(transfer.curl, CURLINFO_RESPONSE_CODE, &statusCode);
+
+        char* contentType;
+        curl_easy_getinfo(transfer.curl, CURLINFO_CONTENT_TYPE, &contentType);
+
+        recordTiming(transfer, numConnects > 0);
+
+        // Responses without any freshness information would not be cached at all, so they get a
+        // heuristic lifetime of 1 hour (RFC 9111, section 4.2.2). Explicit Cache-Control directives,
+        // including no-cache, are left alone.
+        if (transfer.responseHeaders.find("Cache-Control") == transfer.responseHeaders.end() &&
+            transfer.responseHeaders.find("Expires") == transfer.responseHeaders.end()) {
+            std::time_t now = std::time(nullptr);
+            std::time_t expires = now + 3600;
+            char expiresStr[100];
+            std::strftime(expiresStr, sizeof(expiresStr), "%a, %d %b %Y %H:%M:%S GMT", std::gmtime(&expires));
+            transfer.responseHeaders["Expires"] = expiresStr;
+        }
+
+        auto response = std::make_unique<CurlAssetResponse>(
+            statusCode,
+            contentType ? contentType : "",
+            std::move(transfer.responseData),
+            std::move(transfer.responseHeaders),
+            _bufferPool
+        );
+        transfer.request->setResponse(std::move(response));
+
+        transfer.promise.resolve(std::static_pointer_cast<CesiumAsync::IAssetRequest>(transfer.request));
     }
 
-    void tick() noexcept override {}
+    void recordTiming(CurlTransfer& transfer, bool newConnection) {
+        // all curl times are microseconds since the start of the transfer
+        curl_off_t nameLookup = 0, connect = 0, appConnect = 0, preTransfer = 0, startTransfer = 0, total = 0;
+        curl_easy_getinfo(transfer.curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+        curl_easy_getinfo(transfer.curl, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(transfer.curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+        curl_easy_getinfo(transfer.curl, CURLINFO_PRETRANSFER_TIME_T, &preTransfer);
+        curl_easy_getinfo(transfer.curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+        curl_easy_getinfo(transfer.curl, CURLINFO_TOTAL_TIME_T, &total);
 
-private:
-    std::string _authToken;
+        auto phase = [](curl_off_t end, curl_off_t start) {
+            return static_cast<uint64_t>(end > start ? end - start : 0);
+        };
+        if (newConnection) {
+            _timingStats.dnsTime.record(static_cast<uint64_t>(nameLookup));
+            _timingStats.connectTime.record(phase(connect, nameLookup));
+            if (appConnect > 0) {
+                _timingStats.tlsTime.record(phase(appConnect, connect));
+            }
+        }
+        _timingStats.timeToFirstByte.record(phase(startTransfer, preTransfer));
+        _timingStats.totalTime.record(static_cast<uint64_t>(total));
+        _timingStats.responseBytes.record(transfer.responseData.size());
+
+        long httpVersion = 0;
+        curl_easy_getinfo(transfer.curl, CURLINFO_HTTP_VERSION, &httpVersion);
+        if (httpVersion == CURL_HTTP_VERSION_3) {
+            _timingStats.http3Requests++;
+        } else if (httpVersion == CURL_HTTP_VERSION_2_0) {
+            _timingStats.http2Requests++;
+        } else {
+            _timingStats.http1Requests++;
+        }
+    }
+
+    static void LockCallback(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* userptr) {
+        static_cast<CurlAssetAccessor*>(userptr)->_shareMutexes[data].lock();
+    }
 
+    static void UnlockCallback(CURL* /*handle*/, curl_lock_data data, void* userptr) {
+        static_cast<CurlAssetAccessor*>(userptr)->_shareMutexes[data].unlock();
+    }
+
+    // libcurl callbacks are C functions; an exception escaping them is undefined behavior, so
+    // allocation failures abort the transfer instead (returning less than was passed in).
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
         size_t realsize = size * nmemb;
-        auto& buffer = *static_cast<std::vector<uint8_t>*>(userp);
-        size_t currentSize = buffer.size();
-        buffer.resize(currentSize + realsize);
-        std::memcpy(buffer.data() + currentSize, contents, realsize);
+        auto& transfer = *static_cast<CurlTransfer*>(userp);
+        auto& buffer = transfer.responseData;
+        try {
+            size_t required = buffer.size() + realsize;
+            if (buffer.capacity() == 0) {
+                // no Content-Length was received; start from a pooled buffer
+                buffer = transfer.bufferPool->acquire(required);
+            } else if (required > buffer.capacity()) {
+                buffer.reserve(std::max(required, buffer.capacity() * 2));
+            }
+            const uint8_t* bytes = static_cast<const uint8_t*>(contents);
+            buffer.insert(buffer.end(), bytes, bytes + realsize);
+        } catch (const std::exception&) {
+            return 0;
+        }
         return realsize;
     }
 
+    static bool IsHeader(const std::string& key, const char* name) {
+        return std::equal(key.begin(), key.end(), name, name + std::strlen(name), [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        });
+    }
+
+    // Whether the response being received can have a body (RFC 9110, section 6.4.1).
+    static bool HasBody(const CurlTransfer& transfer) {
+        if (transfer.request->method() == "HEAD") {
+            return false;
+        }
+        long statusCode = 0;
+        curl_easy_getinfo(transfer.curl, CURLINFO_RESPONSE_CODE, &statusCode);
+        return statusCode >= 200 && statusCode != 204 && statusCode != 304;
+    }
+
     static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
         size_t totalSize = size * nitems;
-        std::string header(buffer, totalSize);
-        auto* headers = static_cast<CesiumAsync::HttpHeaders*>(userdata);
-        
-        // Find the colon separator
-        size_t colonPos = header.find(':');
-        if (colonPos != std::string::npos) {
-            std::string key = header.substr(0, colonPos);
-            std::string value = header.substr(colonPos + 1);
+        auto& transfer = *static_cast<CurlTransfer*>(userdata);
+        try {
+            std::string header(buffer, totalSize);
+            auto* headers = &transfer.responseHeaders;
             
-            // Trim whitespace
-            key.erase(0, key.find_first_not_of(" \t\r\n"));
-            key.erase(key.find_last_not_of(" \t\r\n") + 1);
-            value.erase(0, value.find_first_not_of(" \t\r\n"));
-            value.erase(value.find_last_not_of(" \t\r\n") + 1);
-            
-            if (!key.empty()) {
-                (*headers)[key] = value;
+            // Find the colon separator
+            size_t colonPos = header.find(':');
+            if (colonPos != std::string::npos) {
+                std::string key = header.substr(0, colonPos);
+                std::string value = header.substr(colonPos + 1);
+                
+                // Trim whitespace
+                key.erase(0, key.find_first_not_of(" \t\r\n"));
+                key.erase(key.find_last_not_of(" \t\r\n") + 1);
+                value.erase(0, value.find_first_not_of(" \t\r\n"));
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                
+                if (!key.empty()) {
+                    (*headers)[key] = value;
+                }
+
+                // Size the body buffer up front so it is allocated once. With a compressed
+                // Content-Encoding this is only a lower bound and WriteCallback grows it. The
+                // header is not trusted beyond the pool's largest buffer.
+                if (IsHeader(key, "Content-Length") && HasBody(transfer)) {
+                    size_t contentLength = std::min<size_t>(
+                        std::strtoull(value.c_str(), nullptr, 10),
+                        transfer.bufferPool->maxBufferCapacity());
+                    auto& body = transfer.responseData;
+                    if (body.capacity() == 0) {
+                        body = transfer.bufferPool->acquire(contentLength);
+                    } else {
+                        body.reserve(body.size() + contentLength);
+                    }
+                }
             }
+        } catch (const std::exception&) {
+            return 0;
         }
         
         return totalSize;
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <Cesium3DTilesSelection/TilesetOptions.h>
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumAsync/ICacheDatabase.h>
+#include <CesiumGltf/Model.h>
+#include <CesiumGltfContent/GltfUtilities.h>
+#include <CesiumGltfWriter/GltfWriter.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "FileAssetAccessor.hpp"
+
+struct DecodedModelCacheStats {
+    uint64_t hits = 0;
+    uint64_t stores = 0;
+};
+
+// A cache of tile models in their decoded form, stored next to the raw responses in the cache
+// database. A stored model is a GLB with a single collapsed buffer from which Draco and meshopt
+// compression have been removed, so loading it again skips those decoders. Images keep their
+// original encoding because the GLB is also what is handed to the renderer.
+//
+// Entries are keyed by URL, the response's ETag (or Last-Modified) and the content options that
+// shaped the model. Responses without a validator are not cached, since a changed tile could not
+// be told apart from the stored one.
+//
+// Decoded entries live in the same database as the raw responses and count against its budget
+// (cacheMaxItems and cacheMaxBytes), so with this cache enabled a stored tile takes up to two
+// entries.
+class DecodedModelCache {
+public:
+    // Set on responses served from this cache, so they are not stored again.
+    static constexpr const char* kDecodedHeader = "X-Cesium-Decoded-Model";
+
+    DecodedModelCache(const std::shared_ptr<CesiumAsync::ICacheDatabase>& pCacheDatabase, const Cesium3DTilesSelection::TilesetContentOptions& contentOptions)
+        : _pCacheDatabase(pCacheDatabase), _optionsKey(createOptionsKey(contentOptions)) {}
+
+    DecodedModelCacheStats getStats() const {
+        DecodedModelCacheStats stats;
+        stats.hits = _hits;
+        stats.stores = _stores;
+        return stats;
+    }
+
+    // Returns the decoded model stored for the response of pRequest, if any.
+    std::shared_ptr<CesiumAsync::IAssetRequest> find(const std::shared_ptr<CesiumAsync::IAssetRequest>& pRequest) {
+        std::optional<std::string> key = createKey(*pRequest);
+        if (!key) {
+            return nullptr;
+        }
+        std::optional<CesiumAsync::CacheItem> item = _pCacheDatabase->getEntry(*key);
+        if (!item) {
+            return nullptr;
+        }
+        _hits++;
+
+        const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+        CesiumAsync::HttpHeaders headers = pResponse->headers();
+        headers[kDecodedHeader] = "1";
+        auto pBody = std::make_shared<std::vector<std::byte>>(std::move(item->cacheResponse.data));
+        gsl::span<const std::byte> body(pBody->data(), pBody->size());
+        return std::make_shared<FileAssetRequest>(
+            pRequest->method(),
+            pRequest->url(),
+            pRequest->headers(),
+            std::make_unique<FileAssetResponse>(pResponse->statusCode(), "model/gltf-binary", body, std::move(pBody), std::move(headers)));
+    }
+
+    // True if store() would keep the model loaded from request: a b3dm or glb response with a
+    // validator that was not itself served from this cache. Checked before the tile's model is
+    // copied, so tiles that are not stored cost nothing.
+    bool shouldStore(const CesiumAsync::IAssetRequest& request) const {
+        const CesiumAsync::IAssetResponse* pResponse = request.response();
+        return pResponse && !pResponse->headers().count(kDecodedHeader) && isSupported(pResponse->data()) &&
+            createKey(request).has_value();
+    }
+
+    // Stores the decoded model loaded from request. Called from a worker thread with a copy of the
+    // tile's model, which is modified here.
+    void store(const CesiumAsync::IAssetRequest& request, CesiumGltf::Model decoded) {
+        if (!shouldStore(request)) {
+            return;
+        }
+        std::optional<std::string> key = createKey(request);
+
+        removeDecodedCompression(decoded);
+        CesiumGltfContent::GltfUtilities::removeUnusedBufferViews(decoded);
+        CesiumGltfContent::GltfUtilities::removeUnusedBuffers(decoded);
+        CesiumGltfContent::GltfUtilities::collapseToSingleBuffer(decoded);
+        if (decoded.buffers.size() > 1) {
+            return;
+        }
+        gsl::span<const std::byte> bufferData;
+        if (!decoded.buffers.empty()) {
+            decoded.buffers[0].uri.reset();
+            bufferData = decoded.buffers[0].cesium.data;
+        }
+
+        CesiumGltfWriter::GltfWriterOptions options;
+        options.binaryChunkByteAlignment = 4;
+        options.prettyPrint = false;
+        CesiumGltfWriter::GltfWriterResult result = CesiumGltfWriter::GltfWriter().writeGlb(decoded, bufferData, options);
+        if (!result.errors.empty()) {
+            spdlog::default_logger()->warn("Failed to write decoded model of {}: {}", request.url(), result.errors.front());
+            return;
+        }
+
+        // the key changes with the validator, so the entry only has to outlive its source
+        std::time_t expiryTime = std::time(nullptr) + kExpirySeconds;
+        _pCacheDatabase->storeEntry(*key, expiryTime, request.url(), request.method(), request.headers(), 200, {}, result.gltfBytes);
+        _stores++;
+    }
+
+    // True for response bodies whose model may be replaced by its decoded form: b3dm and binary glTF.
+    static bool isSupported(gsl::span<const std::byte> data) {
+        return data.size() >= 4 &&
+            (std::memcmp(data.data(), "glTF", 4) == 0 || std::memcmp(data.data(), "b3dm", 4) == 0);
+    }
+
+private:
+    static constexpr std::time_t kExpirySeconds = 30 * 24 * 60 * 60;
+
+    std::shared_ptr<CesiumAsync::ICacheDatabase> _pCacheDatabase;
+    std::string _optionsKey;
+    std::atomic<uint64_t> _hits { 0 };
+    std::atomic<uint64_t> _stores { 0 };
+
+    std::optional<std::string> createKey(const CesiumAsync::IAssetRequest& request) const {
+        const CesiumAsync::IAssetResponse* pResponse = request.response();
+        if (!pResponse || pResponse->statusCode() != 200) {
+            return std::nullopt;
+        }
+        auto validator = pResponse->headers().find("ETag");
+        if (validator == pResponse->headers().end()) {
+            validator = pResponse->headers().find("Last-Modified");
+        }
+        if (validator == pResponse->headers().end()) {
+            return std::nullopt;
+        }
+        return "decoded-gltf:" + _optionsKey + ":" + validator->second + ":" + request.url();
+    }
+
+    // Bump the version whenever the stored form changes.
+    static std::string createOptionsKey(const Cesium3DTilesSelection::TilesetContentOptions& options) {
+        const CesiumGltf::Ktx2TranscodeTargets& targets = options.ktx2TranscodeTargets;
+        std::string key = "v1/";
+        for (bool flag : { options.enableWaterMask, options.generateMissingNormalsSmooth, options.applyTextureTransform }) {
+            key.push_back(flag ? '1' : '0');
+        }
+        for (CesiumGltf::GpuCompressedPixelFormat format : { targets.ETC1S_R, targets.ETC1S_RG, targets.ETC1S_RGB, targets.ETC1S_RGBA,
+                 targets.UASTC_R, targets.UASTC_RG, targets.UASTC_RGB, targets.UASTC_RGBA }) {
+            key += "/" + std::to_string(static_cast<int>(format));
+        }
+        return key;
+    }
+
+    // GltfReader has already decoded Draco and meshopt data into plain buffers; dropping the
+    // extensions leaves the compressed data unreferenced, so it is removed with the unused views.
+    static void removeDecodedCompression(CesiumGltf::Model& model) {
+        static const std::vector<std::string> kExtensions = {
+            "KHR_draco_mesh_compression", "EXT_meshopt_compression", "KHR_meshopt_compression"
+        };
+        for (CesiumGltf::Mesh& mesh : model.meshes) {
+            for (CesiumGltf::MeshPrimitive& primitive : mesh.primitives) {
+                primitive.extensions.erase("KHR_draco_mesh_compression");
+            }
+        }
+        for (CesiumGltf::BufferView& bufferView : model.bufferViews) {
+            bufferView.extensions.erase("EXT_meshopt_compression");
+            bufferView.extensions.erase("KHR_meshopt_compression");
+        }
+        for (auto* pList : { &model.extensionsUsed, &model.extensionsRequired }) {
+            pList->erase(std::remove_if(pList->begin(), pList->end(), [](const std::string& extension) {
+                return std::find(kExtensions.begin(), kExtensions.end(), extension) != kExtensions.end();
+            }), pList->end());
+        }
+    }
+};
+
+// A per-tileset IAssetAccessor decorator that replaces b3dm and glb responses with their decoded
+// form from a DecodedModelCache. The raw response is still fetched (usually from the HTTP cache) to
+// learn its current validator; only the decoding is skipped.
+class DecodedModelAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    DecodedModelAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor, const std::shared_ptr<DecodedModelCache>& pCache)
+        : _pAssetAccessor(pAssetAccessor), _pCache(pCache) {}
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        auto future = _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        if (verb != "GET") {
+            return future;
+        }
+        return std::move(future).thenInWorkerThread([pCache = _pCache](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+            const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+            if (!pResponse || !DecodedModelCache::isSupported(pResponse->data())) {
+                return std::move(pRequest);
+            }
+            std::shared_ptr<CesiumAsync::IAssetRequest> pDecoded = pCache->find(pRequest);
+            return pDecoded ? pDecoded : std::move(pRequest);
+        });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::shared_ptr<DecodedModelCache> _pCache;
+};
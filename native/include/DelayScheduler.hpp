@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Runs callbacks after a delay on a single timer thread, so that code waiting for a backoff
+// or timeout does not have to park a worker thread. Callbacks should be short; anything
+// expensive should be posted on to the AsyncSystem.
+class DelayScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    DelayScheduler() : _thread(&DelayScheduler::run, this) {}
+
+    ~DelayScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _condition.notify_all();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    void schedule(Clock::duration delay, std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push(Task { Clock::now() + delay, _nextSequence++, std::move(callback) });
+        }
+        _condition.notify_all();
+    }
+
+private:
+    struct Task {
+        Clock::time_point due;
+        uint64_t sequence;
+        std::function<void()> callback;
+
+        // std::priority_queue is a max-heap; order so the earliest (then oldest) task is on top
+        bool operator<(const Task& other) const {
+            return due != other.due ? due > other.due : sequence > other.sequence;
+        }
+    };
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::priority_queue<Task> _tasks;
+    uint64_t _nextSequence = 0;
+    bool _running = true;
+    std::thread _thread;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (_running) {
+            if (_tasks.empty()) {
+                _condition.wait(lock);
+                continue;
+            }
+            auto due = _tasks.top().due;
+            if (Clock::now() < due) {
+                _condition.wait_until(lock, due);
+                continue;
+            }
+            std::function<void()> callback = std::move(const_cast<Task&>(_tasks.top()).callback);
+            _tasks.pop();
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+};
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumUtility/Uri.h>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A read-only memory mapping of a whole file. The mapping is released when the object is destroyed.
+class MappedFile {
+public:
+    // Maps the file at path. Returns nullptr if the file does not exist; throws if it exists but cannot be mapped.
+    static std::shared_ptr<MappedFile> open(const std::string& path) {
+        auto pFile = std::shared_ptr<MappedFile>(new MappedFile());
+#ifdef _WIN32
+        int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring widePath(length > 0 ? length - 1 : 0, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), length);
+
+        HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            DWORD error = GetLastError();
+            if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) {
+                return nullptr;
+            }
+            throw std::runtime_error("Failed to open " + path + " (error " + std::to_string(error) + ")");
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to get size of " + path);
+        }
+        pFile->_size = static_cast<size_t>(size.QuadPart);
+        if (pFile->_size > 0) {
+            pFile->_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (pFile->_mapping) {
+                pFile->_data = MapViewOfFile(pFile->_mapping, FILE_MAP_READ, 0, 0, 0);
+            }
+        }
+        CloseHandle(file);
+        if (pFile->_size > 0 && !pFile->_data) {
+            throw std::runtime_error("Failed to map " + path);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == ENOENT || errno == ENOTDIR) {
+                return nullptr;
+            }
+            throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Failed to stat " + path + ": " + std::strerror(error));
+        }
+        pFile->_size = static_cast<size_t>(info.st_size);
+        if (pFile->_size > 0) {
+            void* data = mmap(nullptr, pFile->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::runtime_error("Failed to map " + path + ": " + std::strerror(error));
+            }
+            // tiles are parsed front to back right after loading; start reading ahead now
+            posix_madvise(data, pFile->_size, POSIX_MADV_WILLNEED);
+            pFile->_data = data;
+        }
+        // the mapping keeps the file contents alive on its own
+        ::close(fd);
+#endif
+        return pFile;
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (_data) {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping) {
+            CloseHandle(_mapping);
+        }
+#else
+        if (_data) {
+            munmap(_data, _size);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    gsl::span<const std::byte> data() const {
+        return gsl::span<const std::byte>(static_cast<const std::byte*>(_data), _size);
+    }
+
+private:
+    MappedFile() = default;
+
+    void* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _mapping = nullptr;
+#endif
+};
+
+// A response whose body is a view of memory kept alive by pOwner (e.g. a MappedFile), which is
+// released together with the response.
+class FileAssetResponse : public CesiumAsync::IAssetResponse {
+public:
+    FileAssetResponse(uint16_t statusCode, const std::string& contentType, gsl::span<const std::byte> data = {}, std::shared_ptr<const void> pOwner = nullptr, CesiumAsync::HttpHeaders headers = {})
+        : _statusCode(statusCode), _contentType(contentType), _headers(std::move(headers)), _data(data), _pOwner(std::move(pOwner)) {}
+
+    virtual uint16_t statusCode() const override { return _statusCode; }
+    virtual const CesiumAsync::HttpHeaders& headers() const override { return _headers; }
+    virtual gsl::span<const std::byte> data() const override {
+        return _data;
+    }
+    virtual std::string contentType() const override {
+        return _contentType;
+    }
+
+private:
+    uint16_t _statusCode;
+    std::string _contentType;
+    CesiumAsync::HttpHeaders _headers;
+    gsl::span<const std::byte> _data;
+    std::shared_ptr<const void> _pOwner;
+};
+
+class FileAssetRequest : public CesiumAsync::IAssetRequest {
+public:
+    FileAssetRequest(const std::string& method, const std::string& url, const CesiumAsync::HttpHeaders& headers, std::unique_ptr<FileAssetResponse> response)
+        : _method(method), _url(url), _headers(headers), _response(std::move(response)) {}
+
+    virtual const std::string& method() const override { return _method; }
+    virtual const std::string& url() const override { return _url; }
+    virtual const CesiumAsync::HttpHeaders& headers() const override { return _headers; }
+    virtual const CesiumAsync::IAssetResponse* response() const override { return _response.get(); }
+
+private:
+    std::string _method;
+    std::string _url;
+    CesiumAsync::HttpHeaders _headers;
+    std::unique_ptr<FileAssetResponse> _response;
+};
+
+// An IAssetAccessor decorator that serves file:// URLs and plain file system paths by memory-mapping
+// the file, so tile parsing reads straight from the page cache instead of a copy. A missing file is
+// answered with a 404 response. All other URLs are passed on to the wrapped accessor.
+class FileAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    FileAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor)
+        : _pAssetAccessor(pAssetAccessor) {}
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        if (!isLocal(url) || (verb != "GET" && verb != "HEAD")) {
+            return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        }
+
+        // open() and mmap() may touch slow storage, so keep them off the calling (usually main) thread
+        return asyncSystem.runInWorkerThread([verb, url, headers]() -> std::shared_ptr<CesiumAsync::IAssetRequest> {
+            std::shared_ptr<MappedFile> pFile = MappedFile::open(getPath(url));
+            auto pResponse = !pFile
+                ? std::make_unique<FileAssetResponse>(404, getContentType(url))
+                : verb == "HEAD"
+                ? std::make_unique<FileAssetResponse>(200, getContentType(url))
+                : std::make_unique<FileAssetResponse>(200, getContentType(url), pFile->data(), pFile);
+            return std::make_shared<FileAssetRequest>(
+                verb,
+                url,
+                CesiumAsync::HttpHeaders(headers.begin(), headers.end()),
+                std::move(pResponse));
+        });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+    // True for file:// URLs and for anything without a URL scheme, which is treated as a path.
+    static bool isLocal(const std::string& url) {
+        if (url.compare(0, 7, "file://") == 0) {
+            return true;
+        }
+        size_t scheme = url.find("://");
+        return scheme == std::string::npos && url.compare(0, 5, "data:") != 0;
+    }
+
+    // Converts a local URL (see isLocal) to a file system path.
+    static std::string getPath(const std::string& url) {
+        if (url.compare(0, 7, "file://") == 0) {
+            return CesiumUtility::Uri::uriPathToNativePath(CesiumUtility::Uri::getPath(url));
+        }
+        // plain paths may still carry a query string from tileset URL resolution
+        return url.substr(0, url.find('?'));
+    }
+
+    static std::string getContentType(const std::string& url) {
+        std::string path = url.substr(0, url.find_first_of("?#"));
+        size_t dot = path.rfind('.');
+        std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        if (extension == "json") {
+            return "application/json";
+        }
+        if (extension == "glb") {
+            return "model/gltf-binary";
+        }
+        if (extension == "gltf") {
+            return "model/gltf+json";
+        }
+        return "application/octet-stream";
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+};
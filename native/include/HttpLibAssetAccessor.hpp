@@ -1,22 +1,28 @@
+#pragma once
+
 #include <Cesium3DTilesSelection/Tileset.h>
 #include <Cesium3DTilesSelection/TilesetExternals.h>
 #include <CesiumAsync/IAssetAccessor.h>
 #include <CesiumAsync/IAssetResponse.h>
 #include <CesiumAsync/AsyncSystem.h>
 #define CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_ZLIB_SUPPORT
 
 #include <httplib.h>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
 using namespace Cesium3DTilesSelection;
 
 class HttplibAssetResponse : public CesiumAsync::IAssetResponse {
 public:
-    HttplibAssetResponse(int statusCode, const httplib::Headers& headers, const std::string& body)
-        : _statusCode(statusCode), _body(body) {
+    HttplibAssetResponse(int statusCode, const httplib::Headers& headers, std::string&& body)
+        : _statusCode(statusCode), _body(std::move(body)) {
         for (const auto& header : headers) {
             _headers.emplace(header.first, header.second);
         }
@@ -61,9 +67,12 @@ private:
 
 class HttplibAssetAccessor : public CesiumAsync::IAssetAccessor {
 public:
-    HttplibAssetAccessor(const std::string& authToken = "") : _authToken(authToken) {}
+    // maxIdleClientsPerHost bounds the number of idle keep-alive connections kept per (scheme, host, port).
+    HttplibAssetAccessor(const std::string& authToken = "", size_t maxIdleClientsPerHost = 8)
+        : _authToken(authToken), _maxIdleClientsPerHost(maxIdleClientsPerHost) {}
 
     void setAuthToken(const std::string& authToken) {
+        std::lock_guard<std::mutex> lock(_mutex);
         _authToken = authToken;
     }
 
@@ -80,82 +89,56 @@ public:
         const std::string& url,
         const std::vector<THeader>& headers,
         const gsl::span<const std::byte>& contentPayload = {}) override {
-       
-        return asyncSystem.runInWorkerThread([this, verb, url, headers, contentPayload]() {
+
+        std::vector<std::byte> payload(contentPayload.begin(), contentPayload.end());
+        return asyncSystem.runInWorkerThread([this, verb, url, headers, payload = std::move(payload)]() {
             auto request = std::make_shared<HttplibAssetRequest>(verb, url, CesiumAsync::HttpHeaders(headers.begin(), headers.end()));
-            
-       // Parse the URL
-            std::regex url_regex("(https?)://([^/:]+)(?::(\\d+))?(/.*)?");
-            std::smatch url_match;
-            if (!std::regex_match(url, url_match, url_regex)) {
+
+            Endpoint endpoint;
+            std::string path;
+            if (!splitUrl(url, endpoint, path)) {
                 throw std::runtime_error("Invalid URL format: " + url);
             }
-            
-            std::string scheme = url_match[1].str();
-            std::string host = url_match[2].str();
-            std::string port = url_match[3].str();
-            std::string path = url_match[4].matched ? url_match[4].str() : "/";
-
-            // Create the client with scheme, host, and port
-            std::unique_ptr<httplib::Client> cli;
-            if (scheme == "https") {
-                cli = std::make_unique<httplib::SSLClient>(host, port.empty() ? 443 : std::stoi(port));
-            } else if (scheme == "http") {
-                cli = std::make_unique<httplib::Client>(host, port.empty() ? 80 : std::stoi(port));
-            } else {
-                throw std::runtime_error("Unsupported scheme: " + scheme);
-            }
-            cli.set_connection_timeout(300);
-            cli.set_read_timeout(300);
-            cli.set_write_timeout(300);
 
-       
             httplib::Headers httplib_headers;
             for (const auto& header : headers) {
                 httplib_headers.emplace(header.first, header.second);
             }
-
-            httplib_headers.emplace("Accept-Encoding", "gzip, deflate");
-
-            if (!_authToken.empty()) {
-                httplib_headers.emplace("Authorization", "Bearer " + _authToken);
+            std::string authToken = getAuthToken();
+            if (!authToken.empty()) {
+                httplib_headers.emplace("Authorization", "Bearer " + authToken);
             }
 
-            std::cout << "Request headers:" << std::endl;
-            for (const auto& header : httplib_headers) {
-                std::cout << header.first << ": " << header.second << std::endl;
-            }
-            std::cout << "requesting " << url << std::endl;
+            std::unique_ptr<httplib::ClientImpl> cli = acquireClient(endpoint);
 
             httplib::Result res;
             if (verb == "GET") {
-                res = cli.Get(path.c_str(), httplib_headers);
+                res = cli->Get(path, httplib_headers);
+            } else if (verb == "HEAD") {
+                res = cli->Head(path, httplib_headers);
             } else if (verb == "POST") {
-                res = cli.Post(path.c_str(), httplib_headers, 
-                               reinterpret_cast<const char*>(contentPayload.data()), 
-                               contentPayload.size(), 
+                res = cli->Post(path, httplib_headers,
+                               reinterpret_cast<const char*>(payload.data()),
+                               payload.size(),
                                "application/octet-stream");
             } else {
                 throw std::runtime_error("Unsupported HTTP method: " + verb);
             }
 
             if (res.error() != httplib::Error::Success) {
+                // the connection is in an unknown state; let the client (and its socket) go
                 std::stringstream errorMsg;
                 errorMsg << "HTTP request failed: " << httplib::to_string(res.error());
                 errorMsg << " (Error code: " << static_cast<int>(res.error()) << ")";
-                
                 if (res) {
                     errorMsg << "\nStatus code: " << res->status;
-                    errorMsg << "\nResponse body: " << res->body;
                 }
-                
-                
-                    std::cout << errorMsg.str() << std::endl;
-                
                 throw std::runtime_error(errorMsg.str());
             }
 
-            auto response = std::make_unique<HttplibAssetResponse>(res->status, res->headers, res->body);
+            releaseClient(endpoint, std::move(cli));
+
+            auto response = std::make_unique<HttplibAssetResponse>(res->status, res->headers, std::move(res->body));
             request->setResponse(std::move(response));
 
             return std::static_pointer_cast<CesiumAsync::IAssetRequest>(request);
@@ -165,5 +148,127 @@ public:
     void tick() noexcept override {}
 
 private:
+    struct Endpoint {
+        std::string scheme;
+        std::string host;
+        int port = 0;
+
+        std::string key() const {
+            return scheme + "://" + host + ":" + std::to_string(port);
+        }
+    };
+
     std::string _authToken;
-};
\ No newline at end of file
+    size_t _maxIdleClientsPerHost;
+    std::mutex _mutex;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<httplib::ClientImpl>>> _idleClients;
+
+    std::string getAuthToken() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _authToken;
+    }
+
+    // Splits scheme://[user@]host[:port][/path][?query][#fragment] into an endpoint and the
+    // request target (path and query). Only http and https are accepted.
+    static bool splitUrl(const std::string& url, Endpoint& endpoint, std::string& path) {
+        size_t schemeEnd = url.find("://");
+        if (schemeEnd == std::string::npos) {
+            return false;
+        }
+        endpoint.scheme = url.substr(0, schemeEnd);
+        for (auto& c : endpoint.scheme) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        if (endpoint.scheme != "http" && endpoint.scheme != "https") {
+            return false;
+        }
+
+        size_t authorityStart = schemeEnd + 3;
+        size_t authorityEnd = url.find_first_of("/?#", authorityStart);
+        std::string authority = url.substr(authorityStart, authorityEnd == std::string::npos ? std::string::npos : authorityEnd - authorityStart);
+        size_t at = authority.rfind('@');
+        if (at != std::string::npos) {
+            authority = authority.substr(at + 1);
+        }
+
+        size_t portStart = std::string::npos;
+        if (!authority.empty() && authority[0] == '[') {
+            // IPv6 literal; httplib expects the address without brackets
+            size_t close = authority.find(']');
+            if (close == std::string::npos) {
+                return false;
+            }
+            endpoint.host = authority.substr(1, close - 1);
+            if (close + 1 < authority.size() && authority[close + 1] == ':') {
+                portStart = close + 2;
+            }
+        } else {
+            size_t colon = authority.find(':');
+            endpoint.host = authority.substr(0, colon);
+            if (colon != std::string::npos) {
+                portStart = colon + 1;
+            }
+        }
+        if (endpoint.host.empty()) {
+            return false;
+        }
+
+        endpoint.port = endpoint.scheme == "https" ? 443 : 80;
+        if (portStart != std::string::npos && portStart < authority.size()) {
+            int port = 0;
+            for (size_t i = portStart; i < authority.size(); i++) {
+                if (authority[i] < '0' || authority[i] > '9') {
+                    return false;
+                }
+                port = port * 10 + (authority[i] - '0');
+                if (port > 65535) {
+                    return false;
+                }
+            }
+            endpoint.port = port;
+        }
+
+        if (authorityEnd == std::string::npos) {
+            path = "/";
+        } else {
+            path = url.substr(authorityEnd, url.find('#', authorityEnd) - authorityEnd);
+            if (path.empty() || path[0] != '/') {
+                path = "/" + path;
+            }
+        }
+        return true;
+    }
+
+    std::unique_ptr<httplib::ClientImpl> acquireClient(const Endpoint& endpoint) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _idleClients.find(endpoint.key());
+            if (it != _idleClients.end() && !it->second.empty()) {
+                auto cli = std::move(it->second.back());
+                it->second.pop_back();
+                return cli;
+            }
+        }
+
+        std::unique_ptr<httplib::ClientImpl> cli;
+        if (endpoint.scheme == "https") {
+            cli = std::make_unique<httplib::SSLClient>(endpoint.host, endpoint.port);
+        } else {
+            cli = std::make_unique<httplib::ClientImpl>(endpoint.host, endpoint.port);
+        }
+        cli->set_keep_alive(true);
+        cli->set_connection_timeout(300);
+        cli->set_read_timeout(300);
+        cli->set_write_timeout(300);
+        return cli;
+    }
+
+    // Returns a client whose connection is still usable to the pool, or drops it if the pool is full.
+    void releaseClient(const Endpoint& endpoint, std::unique_ptr<httplib::ClientImpl>&& cli) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& idle = _idleClients[endpoint.key()];
+        if (idle.size() < _maxIdleClientsPerHost) {
+            idle.push_back(std::move(cli));
+        }
+    }
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+// An IAssetAccessor decorator that runs the accessors below it on a separate AsyncSystem whose
+// workers only do I/O: SQLite lookups and writes, memory-mapping local files, reading archives and
+// decoding Content-Encoding. Blocking calls there cannot occupy the workers that decode tile content.
+// The response is handed back through a promise of the requester's AsyncSystem, so whatever the
+// requester chains onto it (glTF parsing, Draco, KTX2, renderer preparation) runs on its own workers.
+//
+// All futures below this accessor belong to the I/O AsyncSystem, which never dispatches main thread
+// tasks, so they may be shared between requesters of different AsyncSystems.
+class IoPoolAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    IoPoolAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor, const CesiumAsync::AsyncSystem& ioAsyncSystem)
+        : _pAssetAccessor(pAssetAccessor), _ioAsyncSystem(ioAsyncSystem) {}
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        // the accessors below already move their blocking work off the calling thread
+        auto promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+        _pAssetAccessor->request(_ioAsyncSystem, verb, url, headers, contentPayload)
+            .thenImmediately([promise](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                promise.resolve(std::move(pRequest));
+            })
+            .catchImmediately([promise](std::exception&&) {
+                promise.reject(std::current_exception());
+            });
+        return promise.getFuture();
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    CesiumAsync::AsyncSystem _ioAsyncSystem;
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <CesiumAsync/ICacheDatabase.h>
+#include <CesiumAsync/CacheItem.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+struct MemoryCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+};
+
+// An in-memory LRU tier in front of a persistent ICacheDatabase. Entries are kept by shared
+// reference, so a hit costs one copy of the body (the ICacheDatabase interface returns items by
+// value) instead of a SQLite query plus a blob copy. Entries read from the persistent tier are
+// promoted into memory; stores go to both tiers, so an entry evicted from memory is still on disk.
+//
+// The byte budget is split evenly between kShards shards with their own lock, so concurrent
+// lookups from the worker threads rarely contend.
+//
+// A hit never reaches the persistent tier, so onHit is called with the key to let it record the
+// access; otherwise its own LRU pruning would evict the most used entries first.
+class MemoryCacheDatabase : public CesiumAsync::ICacheDatabase {
+public:
+    static constexpr size_t kShards = 16;
+
+    MemoryCacheDatabase(
+        const std::shared_ptr<CesiumAsync::ICacheDatabase>& pCacheDatabase,
+        size_t maxBytes,
+        std::function<void(const std::string&)> onHit = nullptr)
+        : _pCacheDatabase(pCacheDatabase), _maxBytesPerShard(maxBytes / kShards), _onHit(std::move(onHit)) {}
+
+    MemoryCacheStats getStats() const {
+        MemoryCacheStats stats;
+        stats.hits = _hits;
+        stats.misses = _misses;
+        stats.evictions = _evictions;
+        for (const Shard& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.entries += shard.entries.size();
+            stats.bytes += shard.bytes;
+        }
+        return stats;
+    }
+
+    // Changes the byte budget, evicting least recently used entries if it shrank.
+    void setMaxBytes(size_t maxBytes) {
+        _maxBytesPerShard = maxBytes / kShards;
+        for (Shard& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            evict(shard, 0);
+        }
+    }
+
+    std::optional<CesiumAsync::CacheItem> getEntry(const std::string& key) const override {
+        Shard& shard = getShard(key);
+        std::shared_ptr<const CesiumAsync::CacheItem> pItem;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(key);
+            if (it != shard.entries.end()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lruPosition);
+                pItem = it->second.pItem;
+            }
+        }
+        if (pItem) {
+            _hits++;
+            if (_onHit) {
+                _onHit(key);
+            }
+            // copy outside the lock; the shared reference keeps the item alive if it is evicted meanwhile
+            return *pItem;
+        }
+
+        _misses++;
+        std::optional<CesiumAsync::CacheItem> item = _pCacheDatabase->getEntry(key);
+        if (item) {
+            insert(shard, key, std::make_shared<const CesiumAsync::CacheItem>(*item));
+        }
+        return item;
+    }
+
+    bool storeEntry(
+        const std::string& key,
+        std::time_t expiryTime,
+        const std::string& url,
+        const std::string& requestMethod,
+        const CesiumAsync::HttpHeaders& requestHeaders,
+        uint16_t statusCode,
+        const CesiumAsync::HttpHeaders& responseHeaders,
+        const gsl::span<const std::byte>& responseData) override {
+
+        if (responseData.size() <= _maxBytesPerShard) {
+            insert(getShard(key), key, std::make_shared<const CesiumAsync::CacheItem>(
+                expiryTime,
+                CesiumAsync::CacheRequest(CesiumAsync::HttpHeaders(requestHeaders), std::string(requestMethod), std::string(url)),
+                CesiumAsync::CacheResponse(statusCode, CesiumAsync::HttpHeaders(responseHeaders), std::vector<std::byte>(responseData.begin(), responseData.end()))));
+        }
+        return _pCacheDatabase->storeEntry(key, expiryTime, url, requestMethod, requestHeaders, statusCode, responseHeaders, responseData);
+    }
+
+    bool prune() override {
+        return _pCacheDatabase->prune();
+    }
+
+    bool clearAll() override {
+        for (Shard& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+            shard.lru.clear();
+            shard.bytes = 0;
+        }
+        return _pCacheDatabase->clearAll();
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const CesiumAsync::CacheItem> pItem;
+        std::list<std::string>::iterator lruPosition;
+        size_t size;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        // most recently used first
+        std::list<std::string> lru;
+        size_t bytes = 0;
+    };
+
+    std::shared_ptr<CesiumAsync::ICacheDatabase> _pCacheDatabase;
+    std::atomic<size_t> _maxBytesPerShard;
+    std::function<void(const std::string&)> _onHit;
+    mutable std::array<Shard, kShards> _shards;
+    mutable std::atomic<uint64_t> _hits { 0 };
+    mutable std::atomic<uint64_t> _misses { 0 };
+    mutable std::atomic<uint64_t> _evictions { 0 };
+
+    Shard& getShard(const std::string& key) const {
+        return _shards[std::hash<std::string>()(key) % kShards];
+    }
+
+    static size_t getSize(const std::string& key, const CesiumAsync::CacheItem& item) {
+        return key.size() + item.cacheRequest.url.size() + item.cacheResponse.data.size();
+    }
+
+    void insert(Shard& shard, const std::string& key, std::shared_ptr<const CesiumAsync::CacheItem> pItem) const {
+        size_t size = getSize(key, *pItem);
+        if (size > _maxBytesPerShard) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            shard.bytes -= it->second.size;
+            shard.lru.erase(it->second.lruPosition);
+            shard.entries.erase(it);
+        }
+        evict(shard, size);
+        shard.lru.push_front(key);
+        shard.entries.emplace(key, Entry { std::move(pItem), shard.lru.begin(), size });
+        shard.bytes += size;
+    }
+
+    // Evicts until size more bytes fit into the shard. Must be called with the shard's mutex held.
+    void evict(Shard& shard, size_t size) const {
+        while (shard.bytes + size > _maxBytesPerShard && !shard.lru.empty()) {
+            auto evicted = shard.entries.find(shard.lru.back());
+            shard.bytes -= evicted->second.size;
+            shard.entries.erase(evicted);
+            shard.lru.pop_back();
+            _evictions++;
+        }
+    }
+};
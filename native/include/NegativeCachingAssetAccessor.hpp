@@ -0,0 +1,142 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FileAssetAccessor.hpp"
+
+struct NegativeCacheStats {
+    // Requests answered with a remembered 404 or 410 instead of being sent.
+    uint64_t hits = 0;
+    uint64_t entries = 0;
+};
+
+// An IAssetAccessor decorator that remembers URLs answered with 404 Not Found or 410 Gone for ttl
+// and answers later GETs of them locally with the same status. Implicit tilesets legitimately
+// reference content and subtrees that do not exist, and CachingAssetAccessor only stores cacheable
+// 2xx responses, so without this every revisit would request them again.
+//
+// At most maxEntries URLs are remembered; the least recently used one is forgotten first.
+class NegativeCachingAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    NegativeCachingAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor, std::chrono::seconds ttl, size_t maxEntries)
+        : _pAssetAccessor(pAssetAccessor), _ttl(ttl), _maxEntries(maxEntries) {}
+
+    NegativeCacheStats getStats() const {
+        NegativeCacheStats stats;
+        stats.hits = _hits;
+        std::lock_guard<std::mutex> lock(_mutex);
+        stats.entries = _entries.size();
+        return stats;
+    }
+
+    // Forgets every remembered URL, e.g. after the missing content may have been published.
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+        _lru.clear();
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        if (verb != "GET") {
+            return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        }
+        if (uint16_t statusCode = find(url)) {
+            _hits++;
+            return asyncSystem.createResolvedFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>(
+                std::make_shared<FileAssetRequest>(
+                    verb,
+                    url,
+                    CesiumAsync::HttpHeaders(headers.begin(), headers.end()),
+                    std::make_unique<FileAssetResponse>(statusCode, "")));
+        }
+        return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload)
+            .thenImmediately([this, url](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+                if (pResponse && (pResponse->statusCode() == 404 || pResponse->statusCode() == 410)) {
+                    insert(url, pResponse->statusCode());
+                }
+                return std::move(pRequest);
+            });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    struct Entry {
+        uint16_t statusCode;
+        std::chrono::steady_clock::time_point expiry;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::chrono::seconds _ttl;
+    size_t _maxEntries;
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, Entry> _entries;
+    // most recently used first
+    std::list<std::string> _lru;
+    std::atomic<uint64_t> _hits { 0 };
+
+    // Returns the remembered status of url, or 0.
+    uint16_t find(const std::string& url) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(url);
+        if (it == _entries.end()) {
+            return 0;
+        }
+        if (it->second.expiry <= std::chrono::steady_clock::now()) {
+            _lru.erase(it->second.lruPosition);
+            _entries.erase(it);
+            return 0;
+        }
+        _lru.splice(_lru.begin(), _lru, it->second.lruPosition);
+        return it->second.statusCode;
+    }
+
+    void insert(const std::string& url, uint16_t statusCode) {
+        if (_maxEntries == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto expiry = std::chrono::steady_clock::now() + _ttl;
+        auto it = _entries.find(url);
+        if (it != _entries.end()) {
+            it->second.statusCode = statusCode;
+            it->second.expiry = expiry;
+            _lru.splice(_lru.begin(), _lru, it->second.lruPosition);
+            return;
+        }
+        while (_entries.size() >= _maxEntries) {
+            _entries.erase(_lru.back());
+            _lru.pop_back();
+        }
+        _lru.push_front(url);
+        _entries.emplace(url, Entry { statusCode, expiry, _lru.begin() });
+    }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// A lock-free histogram with power-of-two buckets: bucket 0 counts zeros and bucket i counts
+// values in [2^(i-1), 2^i). The last bucket also counts everything larger. Recording is a few
+// relaxed atomic adds, so it is cheap enough to do for every request on the I/O thread.
+class Histogram {
+public:
+    static constexpr size_t kBuckets = 32;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::array<uint64_t, kBuckets> buckets {};
+    };
+
+    void record(uint64_t value) {
+        size_t bucket = 0;
+        while (bucket < kBuckets - 1 && value >= (uint64_t(1) << bucket)) {
+            bucket++;
+        }
+        _buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = _max.load(std::memory_order_relaxed);
+        while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Returns the current values. If reset is true, the histogram is cleared at the same time so
+    // that the next snapshot covers a new measurement window. Values recorded concurrently end up
+    // in exactly one window, though possibly split across fields.
+    Snapshot snapshot(bool reset) {
+        Snapshot snapshot;
+        snapshot.count = take(_count, reset);
+        snapshot.sum = take(_sum, reset);
+        snapshot.max = take(_max, reset);
+        for (size_t i = 0; i < kBuckets; i++) {
+            snapshot.buckets[i] = take(_buckets[i], reset);
+        }
+        return snapshot;
+    }
+
+private:
+    std::atomic<uint64_t> _count { 0 };
+    std::atomic<uint64_t> _sum { 0 };
+    std::atomic<uint64_t> _max { 0 };
+    std::array<std::atomic<uint64_t>, kBuckets> _buckets {};
+
+    static uint64_t take(std::atomic<uint64_t>& value, bool reset) {
+        return reset ? value.exchange(0, std::memory_order_relaxed) : value.load(std::memory_order_relaxed);
+    }
+};
+
+// Per-request timing breakdown of completed transfers. Times are in microseconds. The DNS,
+// connect and TLS phases are only recorded for requests that opened a new connection, since
+// they are zero for requests sent over a reused one.
+struct NetworkTimingStats {
+    Histogram dnsTime;
+    Histogram connectTime;
+    Histogram tlsTime;
+    // Time from the request being sent until the first response byte.
+    Histogram timeToFirstByte;
+    Histogram totalTime;
+    Histogram responseBytes;
+
+    std::atomic<uint64_t> http1Requests { 0 };
+    std::atomic<uint64_t> http2Requests { 0 };
+    std::atomic<uint64_t> http3Requests { 0 };
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "FileAssetAccessor.hpp"
+#include "RequestCancelledError.hpp"
+#include "WriteBehindSqliteCache.hpp"
+
+// An IAssetAccessor decorator that sits directly above CachingAssetAccessor and answers a failed
+// GET with the pinned cache entry of its URL (see WriteBehindSqliteCache::pin), even if that has
+// expired. CachingAssetAccessor refetches expired entries and fails when the network does, so
+// without this a seeded region could only be viewed offline until its entries expired.
+// Cancelled requests are not answered; nobody is waiting for them.
+class PinnedFallbackAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    PinnedFallbackAssetAccessor(
+        const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor,
+        const std::shared_ptr<WriteBehindSqliteCache>& pCache)
+        : _pAssetAccessor(pAssetAccessor), _pCache(pCache) {}
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        auto future = _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        if (verb != "GET" || !contentPayload.empty()) {
+            return future;
+        }
+        // the lookup is a SQLite query; keep it off libcurl's I/O thread
+        return std::move(future).catchImmediately([asyncSystem, pCache = _pCache, url, headers](std::exception&&) {
+            std::exception_ptr error = std::current_exception();
+            return asyncSystem.runInWorkerThread([pCache, url, headers, error]() -> std::shared_ptr<CesiumAsync::IAssetRequest> {
+                std::optional<CesiumAsync::CacheItem> item;
+                if (!isCancellation(error)) {
+                    // CachingAssetAccessor keys entries by URL
+                    item = pCache->getPinnedEntry(url);
+                }
+                if (!item) {
+                    std::rethrow_exception(error);
+                }
+
+                CesiumAsync::CacheResponse& response = item->cacheResponse;
+                auto contentType = response.headers.find("Content-Type");
+                auto pBody = std::make_shared<std::vector<std::byte>>(std::move(response.data));
+                gsl::span<const std::byte> body(pBody->data(), pBody->size());
+                return std::make_shared<FileAssetRequest>(
+                    "GET",
+                    url,
+                    CesiumAsync::HttpHeaders(headers.begin(), headers.end()),
+                    std::make_unique<FileAssetResponse>(
+                        response.statusCode,
+                        contentType != response.headers.end() ? contentType->second : std::string(),
+                        body,
+                        std::move(pBody),
+                        std::move(response.headers)));
+            });
+        });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::shared_ptr<WriteBehindSqliteCache> _pCache;
+
+    static bool isCancellation(const std::exception_ptr& error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const RequestCancelledError&) {
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+};
@@ -5,6 +5,9 @@
 #include <memory>
 #include <vector>
 
+#include "DecodedModelCache.hpp"
+#include "TaskPriority.hpp"
+
 using namespace Cesium3DTilesSelection;
 
 class SimplePrepareRendererResource
@@ -32,7 +35,20 @@ public:
       const CesiumAsync::AsyncSystem& asyncSystem,
       TileLoadResult&& tileLoadResult,
       const glm::dmat4& /*transform*/,
-      const std::any& /*rendererOptions*/) override {
+      const std::any& rendererOptions) override {
+    // tilesets with cacheDecodedModels pass their DecodedModelCache as renderer options
+    auto ppDecodedModelCache = std::any_cast<std::shared_ptr<DecodedModelCache>>(&rendererOptions);
+    const CesiumGltf::Model* pModel = std::get_if<CesiumGltf::Model>(&tileLoadResult.contentKind);
+    if (ppDecodedModelCache && pModel && tileLoadResult.pCompletedRequest &&
+        (*ppDecodedModelCache)->shouldStore(*tileLoadResult.pCompletedRequest)) {
+      // the model is only copied for tiles that will be stored; writing the GLB does not hold up the tile; it runs behind the tile loads
+      TaskPriorityScope scope(TaskPriority::Background);
+      asyncSystem.runInWorkerThread([pCache = *ppDecodedModelCache,
+                                     pRequest = tileLoadResult.pCompletedRequest,
+                                     model = *pModel]() mutable {
+        pCache->store(*pRequest, std::move(model));
+      });
+    }
     return asyncSystem.createResolvedFuture(TileLoadResultAndRenderResources{
         std::move(tileLoadResult),
         new AllocationResult{totalAllocation}});
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TaskPriority.hpp"
+
+// An IAssetAccessor decorator that carries the task priority of the requesting thread across the
+// request. Responses are resolved by libcurl's I/O thread, the throttling thread or a timer, and
+// continuations started from there would otherwise all get that thread's default priority. The
+// returned future is resolved inside a TaskPriorityScope of the requester's priority instead, so
+// the decoding of a response queues behind or ahead of other work like the request that asked for it.
+class PriorityAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    PriorityAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor)
+        : _pAssetAccessor(pAssetAccessor) {}
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        TaskPriority priority = getCurrentTaskPriority();
+        auto promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+        _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload)
+            .thenImmediately([promise, priority](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                TaskPriorityScope scope(priority);
+                promise.resolve(std::move(pRequest));
+            })
+            .catchImmediately([promise, priority](std::exception&&) {
+                TaskPriorityScope scope(priority);
+                promise.reject(std::current_exception());
+            });
+        return promise.getFuture();
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+};
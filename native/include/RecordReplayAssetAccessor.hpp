@@ -0,0 +1,292 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "DelayScheduler.hpp"
+#include "FileAssetAccessor.hpp"
+
+// On-disk format shared by RecordingAssetAccessor and ReplayAssetAccessor: an 8-byte magic
+// followed by one record per completed request. All integers are little-endian:
+//
+//   u32 keyLength, key ("<verb> <url>", followed by " #<payload hash>" for requests with a body)
+//   u16 statusCode
+//   u32 contentTypeLength, contentType
+//   u32 headerCount, then per header: u32 nameLength, name, u32 valueLength, value
+//   u64 latency in microseconds
+//   u64 bodyLength, body
+struct AssetRecordingFormat {
+    static constexpr char kMagic[8] = { 'C', 'T', 'R', 'E', 'C', '0', '0', '1' };
+
+    // Requests with a body (e.g. POST) are told apart by a 64-bit FNV-1a hash of the body.
+    static std::string createKey(const std::string& verb, const std::string& url, const gsl::span<const std::byte>& payload) {
+        std::string key = verb + " " + url;
+        if (!payload.empty()) {
+            uint64_t hash = 14695981039346656037ull;
+            for (std::byte b : payload) {
+                hash = (hash ^ static_cast<uint64_t>(b)) * 1099511628211ull;
+            }
+            static const char kHexDigits[] = "0123456789abcdef";
+            key += " #";
+            for (int shift = 60; shift >= 0; shift -= 4) {
+                key.push_back(kHexDigits[(hash >> shift) & 0xf]);
+            }
+        }
+        return key;
+    }
+};
+
+// An IAssetAccessor decorator that appends every completed request of the wrapped accessor to a
+// recording file, so a session can later be replayed with ReplayAssetAccessor. Failed requests
+// (network errors) are not recorded; HTTP error responses are.
+class RecordingAssetAccessor : public CesiumAsync::IAssetAccessor, public std::enable_shared_from_this<RecordingAssetAccessor> {
+public:
+    RecordingAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor, const std::string& path)
+        : _pAssetAccessor(pAssetAccessor), _path(path) {
+        _stream.open(path, std::ios::binary | std::ios::trunc);
+        if (!_stream) {
+            throw std::runtime_error("Failed to open recording file " + path);
+        }
+        _stream.write(AssetRecordingFormat::kMagic, sizeof(AssetRecordingFormat::kMagic));
+        spdlog::default_logger()->info("Recording tile requests to {}", path);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+        auto start = std::chrono::steady_clock::now();
+        auto pThis = shared_from_this();
+        std::string key = AssetRecordingFormat::createKey(verb, url, contentPayload);
+        return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload)
+            .thenImmediately([pThis, key, start](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                if (pRequest->response()) {
+                    pThis->write(key, *pRequest->response(), latency);
+                }
+                return std::move(pRequest);
+            });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::string _path;
+    std::mutex _mutex;
+    std::ofstream _stream;
+
+    void writeU16(uint16_t value) {
+        char bytes[2] = { static_cast<char>(value), static_cast<char>(value >> 8) };
+        _stream.write(bytes, 2);
+    }
+
+    void writeU32(uint32_t value) {
+        writeU16(static_cast<uint16_t>(value));
+        writeU16(static_cast<uint16_t>(value >> 16));
+    }
+
+    void writeU64(uint64_t value) {
+        writeU32(static_cast<uint32_t>(value));
+        writeU32(static_cast<uint32_t>(value >> 32));
+    }
+
+    void writeString(const std::string& value) {
+        writeU32(static_cast<uint32_t>(value.size()));
+        _stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    void write(const std::string& key, const CesiumAsync::IAssetResponse& response, std::chrono::microseconds latency) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        writeString(key);
+        writeU16(response.statusCode());
+        writeString(response.contentType());
+        writeU32(static_cast<uint32_t>(response.headers().size()));
+        for (const auto& [name, value] : response.headers()) {
+            writeString(name);
+            writeString(value);
+        }
+        writeU64(static_cast<uint64_t>(latency.count()));
+        gsl::span<const std::byte> body = response.data();
+        writeU64(body.size());
+        _stream.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+        // flush every record so that a recording survives the app being killed
+        _stream.flush();
+        if (!_stream) {
+            spdlog::default_logger()->error("Failed to write to recording file {}", _path);
+        }
+    }
+};
+
+// An IAssetAccessor that answers requests from a file written by RecordingAssetAccessor, without
+// any network access. The file is memory-mapped and response bodies are served straight from the
+// mapping. A URL requested several times during recording is replayed in the recorded order, with
+// the last response repeated after that. Requests that were not recorded receive a 404 response.
+//
+// If simulateLatency is true, each response is delivered after its recorded latency.
+class ReplayAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    ReplayAssetAccessor(const std::string& path, bool simulateLatency, const std::shared_ptr<DelayScheduler>& pDelayScheduler)
+        : _simulateLatency(simulateLatency), _pDelayScheduler(pDelayScheduler) {
+        _pFile = MappedFile::open(path);
+        if (!_pFile) {
+            throw std::runtime_error("Recording file " + path + " does not exist");
+        }
+        load(path);
+        spdlog::default_logger()->info("Replaying {} recorded requests from {}", _recordCount, path);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        const Record* pRecord = next(AssetRecordingFormat::createKey(verb, url, contentPayload));
+        std::unique_ptr<FileAssetResponse> pResponse;
+        if (pRecord) {
+            pResponse = std::make_unique<FileAssetResponse>(pRecord->statusCode, pRecord->contentType, pRecord->body, _pFile, pRecord->headers);
+        } else {
+            spdlog::default_logger()->warn("No recorded response for {} {}", verb, url);
+            pResponse = std::make_unique<FileAssetResponse>(404, "");
+        }
+        std::shared_ptr<CesiumAsync::IAssetRequest> pRequest = std::make_shared<FileAssetRequest>(
+            verb,
+            url,
+            CesiumAsync::HttpHeaders(headers.begin(), headers.end()),
+            std::move(pResponse));
+
+        if (!_simulateLatency || !pRecord || pRecord->latency.count() == 0) {
+            return asyncSystem.createResolvedFuture(std::move(pRequest));
+        }
+        auto promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+        _pDelayScheduler->schedule(pRecord->latency, [promise, pRequest]() {
+            promise.resolve(std::shared_ptr<CesiumAsync::IAssetRequest>(pRequest));
+        });
+        return promise.getFuture();
+    }
+
+    void tick() noexcept override {}
+
+private:
+    struct Record {
+        uint16_t statusCode;
+        std::string contentType;
+        CesiumAsync::HttpHeaders headers;
+        std::chrono::microseconds latency;
+        gsl::span<const std::byte> body;
+    };
+
+    struct RecordList {
+        std::vector<Record> records;
+        size_t next = 0;
+    };
+
+    bool _simulateLatency;
+    std::shared_ptr<DelayScheduler> _pDelayScheduler;
+    std::shared_ptr<MappedFile> _pFile;
+    std::mutex _mutex;
+    std::unordered_map<std::string, RecordList> _records;
+    size_t _recordCount = 0;
+
+    const Record* next(const std::string& key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _records.find(key);
+        if (it == _records.end()) {
+            return nullptr;
+        }
+        RecordList& list = it->second;
+        const Record* pRecord = &list.records[std::min(list.next, list.records.size() - 1)];
+        list.next++;
+        return pRecord;
+    }
+
+    void load(const std::string& path) {
+        gsl::span<const std::byte> data = _pFile->data();
+        size_t position = 0;
+
+        auto take = [&](size_t size) {
+            if (size > data.size() - position) {
+                throw std::runtime_error("Recording file " + path + " is truncated");
+            }
+            const std::byte* p = data.data() + position;
+            position += size;
+            return p;
+        };
+        auto readU16 = [&]() {
+            const std::byte* p = take(2);
+            return static_cast<uint16_t>(static_cast<uint16_t>(p[0]) | static_cast<uint16_t>(p[1]) << 8);
+        };
+        auto readU32 = [&]() {
+            uint32_t low = readU16();
+            return low | static_cast<uint32_t>(readU16()) << 16;
+        };
+        auto readU64 = [&]() {
+            uint64_t low = readU32();
+            return low | static_cast<uint64_t>(readU32()) << 32;
+        };
+        auto readString = [&]() {
+            uint32_t length = readU32();
+            return std::string(reinterpret_cast<const char*>(take(length)), length);
+        };
+
+        if (data.size() < sizeof(AssetRecordingFormat::kMagic) ||
+            std::memcmp(take(sizeof(AssetRecordingFormat::kMagic)), AssetRecordingFormat::kMagic, sizeof(AssetRecordingFormat::kMagic)) != 0) {
+            throw std::runtime_error(path + " is not a tile request recording");
+        }
+
+        while (position < data.size()) {
+            try {
+                std::string key = readString();
+                Record record;
+                record.statusCode = readU16();
+                record.contentType = readString();
+                uint32_t headerCount = readU32();
+                for (uint32_t i = 0; i < headerCount; i++) {
+                    std::string name = readString();
+                    record.headers[name] = readString();
+                }
+                record.latency = std::chrono::microseconds(readU64());
+                uint64_t bodyLength = readU64();
+                record.body = gsl::span<const std::byte>(take(bodyLength), bodyLength);
+                _records[key].records.push_back(std::move(record));
+                _recordCount++;
+            } catch (const std::runtime_error&) {
+                // a recording cut short by the app being killed ends in a partial record
+                spdlog::default_logger()->warn("Ignoring truncated record at the end of {}", path);
+                break;
+            }
+        }
+    }
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <Cesium3DTilesSelection/Tileset.h>
+#include <Cesium3DTilesSelection/TilesetExternals.h>
+#include <Cesium3DTilesSelection/ViewState.h>
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumGeospatial/Cartographic.h>
+#include <CesiumGeospatial/Ellipsoid.h>
+#include <CesiumGeospatial/GlobeTransforms.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <spdlog/spdlog.h>
+
+#include "TaskPriority.hpp"
+#include "WriteBehindSqliteCache.hpp"
+
+// The area to pre-load into the tile cache. Angles are in degrees, heights in meters above the
+// WGS84 ellipsoid.
+struct SeedRegion {
+    double west = 0.0;
+    double south = 0.0;
+    double east = 0.0;
+    double north = 0.0;
+    double minHeight = 0.0;
+    double maxHeight = 0.0;
+    // The screen-space error the tiles are loaded for; lower values load more detail.
+    double maximumScreenSpaceError = 16.0;
+    // The region is covered by viewpointsPerAxis x viewpointsPerAxis nadir views.
+    uint32_t viewpointsPerAxis = 4;
+};
+
+struct SeedProgress {
+    enum class State { Running, Done, Cancelled, Failed };
+
+    State state = State::Running;
+    uint32_t completedViewpoints = 0;
+    uint32_t totalViewpoints = 0;
+    // Responses received while seeding, including ones that were already cached.
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+};
+
+// Counts the responses and bytes of the seeding tileset's requests and pins their cache entries,
+// so the region stays in the cache until it is cleared.
+class SeedCountingAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    SeedCountingAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor, const std::shared_ptr<WriteBehindSqliteCache>& pCache)
+        : _pAssetAccessor(pAssetAccessor), _pCache(pCache) {}
+
+    std::atomic<uint64_t> requests { 0 };
+    std::atomic<uint64_t> bytes { 0 };
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+        return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload)
+            .thenImmediately([this, url](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                if (const CesiumAsync::IAssetResponse* pResponse = pRequest->response()) {
+                    requests++;
+                    bytes += pResponse->data().size();
+                    // CachingAssetAccessor has stored the response by now, keyed by URL
+                    if (_pCache) {
+                        _pCache->pin(url);
+                    }
+                }
+                return std::move(pRequest);
+            });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::shared_ptr<WriteBehindSqliteCache> _pCache;
+};
+
+// Pre-loads every tile needed to view a region into the tile cache, so the region can later be
+// viewed without network access. The region is covered with a grid of synthetic nadir viewpoints,
+// and Tileset::updateViewOffline loads the tiles of one viewpoint after the other on a dedicated
+// thread. The seeding tileset has its own AsyncSystem, since updateViewOffline dispatches main
+// thread tasks and must not run those of the application's tilesets. It keeps no tiles in memory
+// beyond the viewpoint being loaded. The cache entries of its requests are pinned, so prune()
+// neither expires nor evicts them.
+//
+// If statePath is given, the number of completed viewpoints is saved there after each one, and a
+// later seeder for the same region continues where that one stopped.
+class RegionSeeder {
+public:
+    using TilesetFactory = std::function<std::unique_ptr<Cesium3DTilesSelection::Tileset>(
+        const Cesium3DTilesSelection::TilesetExternals&, const Cesium3DTilesSelection::TilesetOptions&)>;
+    using ProgressCallback = std::function<void(const SeedProgress&)>;
+
+    RegionSeeder(
+        const SeedRegion& region,
+        uint32_t maxConcurrentRequests,
+        const std::string& statePath,
+        const Cesium3DTilesSelection::TilesetExternals& externals,
+        const std::shared_ptr<WriteBehindSqliteCache>& pCache,
+        TilesetFactory createTileset,
+        ProgressCallback onProgress)
+        : _region(region), _statePath(statePath), _externals(externals), _onProgress(std::move(onProgress)) {
+        _pCountingAssetAccessor = std::make_shared<SeedCountingAssetAccessor>(externals.pAssetAccessor, pCache);
+        _externals.pAssetAccessor = _pCountingAssetAccessor;
+
+        Cesium3DTilesSelection::TilesetOptions options;
+        options.maximumScreenSpaceError = region.maximumScreenSpaceError;
+        options.maximumSimultaneousTileLoads = std::max<uint32_t>(maxConcurrentRequests, 1);
+        // only the cache needs the tiles; release each one once the next viewpoint is loaded
+        options.maximumCachedBytes = 0;
+        options.enableFrustumCulling = true;
+        options.enableFogCulling = false;
+        options.forbidHoles = true;
+        options.loadErrorCallback = [](const Cesium3DTilesSelection::TilesetLoadFailureDetails& details) {
+            spdlog::default_logger()->warn("Seeding: {}", details.message);
+        };
+
+        _thread = std::thread([this, createTileset = std::move(createTileset), options]() {
+            run(createTileset, options);
+        });
+    }
+
+    // Waits for the viewpoint being loaded to complete.
+    ~RegionSeeder() {
+        cancel();
+        _thread.join();
+    }
+
+    RegionSeeder(const RegionSeeder&) = delete;
+    RegionSeeder& operator=(const RegionSeeder&) = delete;
+
+    // Stops after the viewpoint currently being loaded.
+    void cancel() {
+        _cancelled = true;
+    }
+
+    // No progress is reported once this returns, e.g. because the callback's receiver is gone.
+    void stopReporting() {
+        std::lock_guard<std::mutex> lock(_progressMutex);
+        _onProgress = nullptr;
+    }
+
+private:
+    static constexpr double kFieldOfView = 1.0471975511965976; // 60 degrees
+    static constexpr double kViewportSize = 1024.0;
+
+    SeedRegion _region;
+    std::string _statePath;
+    Cesium3DTilesSelection::TilesetExternals _externals;
+    std::mutex _progressMutex;
+    ProgressCallback _onProgress;
+    std::shared_ptr<SeedCountingAssetAccessor> _pCountingAssetAccessor;
+    std::atomic<bool> _cancelled { false };
+    std::thread _thread;
+
+    void run(const TilesetFactory& createTileset, const Cesium3DTilesSelection::TilesetOptions& options) {
+        // seeding only runs on otherwise idle worker threads
+        TaskPriorityScope scope(TaskPriority::Prefetch);
+        std::vector<Cesium3DTilesSelection::ViewState> viewpoints = createViewpoints();
+        SeedProgress progress;
+        progress.totalViewpoints = static_cast<uint32_t>(viewpoints.size());
+        progress.completedViewpoints = std::min(loadCompletedViewpoints(), progress.totalViewpoints);
+
+        std::unique_ptr<Cesium3DTilesSelection::Tileset> pTileset;
+        try {
+            pTileset = createTileset(_externals, options);
+            while (progress.completedViewpoints < progress.totalViewpoints && !_cancelled) {
+                pTileset->updateViewOffline({ viewpoints[progress.completedViewpoints] });
+                progress.completedViewpoints++;
+                saveCompletedViewpoints(progress.completedViewpoints);
+                report(progress);
+            }
+            progress.state = _cancelled && progress.completedViewpoints < progress.totalViewpoints
+                ? SeedProgress::State::Cancelled
+                : SeedProgress::State::Done;
+        } catch (const std::exception& e) {
+            spdlog::default_logger()->error("Seeding failed: {}", e.what());
+            progress.state = SeedProgress::State::Failed;
+        }
+
+        if (pTileset) {
+            std::atomic<bool> destroyed { false };
+            pTileset->getAsyncDestructionCompleteEvent().thenImmediately([&destroyed]() { destroyed = true; });
+            pTileset.reset();
+            while (!destroyed) {
+                _externals.asyncSystem.dispatchMainThreadTasks();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        report(progress);
+    }
+
+    void report(SeedProgress& progress) {
+        progress.requests = _pCountingAssetAccessor->requests;
+        progress.bytes = _pCountingAssetAccessor->bytes;
+        std::lock_guard<std::mutex> lock(_progressMutex);
+        if (_onProgress) {
+            _onProgress(progress);
+        }
+    }
+
+    // A grid of cameras looking straight down, each placed high enough for its cell to fill the
+    // view at the bottom of the height range. A region with east < west crosses the antimeridian.
+    std::vector<Cesium3DTilesSelection::ViewState> createViewpoints() const {
+        const CesiumGeospatial::Ellipsoid& ellipsoid = CesiumGeospatial::Ellipsoid::WGS84;
+        uint32_t count = std::max<uint32_t>(_region.viewpointsPerAxis, 1);
+        double width = _region.east - _region.west;
+        if (width < 0.0) {
+            width += 360.0;
+        }
+        double cellWidth = width / count;
+        double cellHeight = (_region.north - _region.south) / count;
+
+        std::vector<Cesium3DTilesSelection::ViewState> viewpoints;
+        for (uint32_t y = 0; y < count; y++) {
+            for (uint32_t x = 0; x < count; x++) {
+                double longitude = glm::radians(_region.west + (x + 0.5) * cellWidth);
+                double latitude = glm::radians(_region.south + (y + 0.5) * cellHeight);
+                double radius = ellipsoid.getMaximumRadius();
+                double halfWidth = 0.5 * glm::radians(cellWidth) * radius * std::cos(latitude);
+                double halfHeight = 0.5 * glm::radians(cellHeight) * radius;
+                double distance = std::sqrt(halfWidth * halfWidth + halfHeight * halfHeight) / std::tan(kFieldOfView / 2.0);
+                double height = std::max(_region.minHeight + distance, _region.maxHeight);
+
+                glm::dvec3 position = ellipsoid.cartographicToCartesian(CesiumGeospatial::Cartographic(longitude, latitude, height));
+                glm::dmat4 enu = CesiumGeospatial::GlobeTransforms::eastNorthUpToFixedFrame(position, ellipsoid);
+                glm::dvec3 north = glm::dvec3(enu[1]);
+                glm::dvec3 up = glm::dvec3(enu[2]);
+                viewpoints.push_back(Cesium3DTilesSelection::ViewState::create(
+                    position, -up, north, glm::dvec2(kViewportSize, kViewportSize), kFieldOfView, kFieldOfView, ellipsoid));
+            }
+        }
+        return viewpoints;
+    }
+
+    // Identifies the region in the state file, so a state file of another region is ignored.
+    std::string getRegionKey() const {
+        std::ostringstream key;
+        key.precision(17);
+        key << _region.west << ' ' << _region.south << ' ' << _region.east << ' ' << _region.north << ' '
+            << _region.minHeight << ' ' << _region.maxHeight << ' ' << _region.maximumScreenSpaceError << ' '
+            << _region.viewpointsPerAxis;
+        return key.str();
+    }
+
+    uint32_t loadCompletedViewpoints() const {
+        if (_statePath.empty()) {
+            return 0;
+        }
+        std::ifstream stream(_statePath);
+        std::string key;
+        uint32_t completed = 0;
+        if (!std::getline(stream, key) || key != getRegionKey() || !(stream >> completed)) {
+            return 0;
+        }
+        spdlog::default_logger()->info("Resuming seeding after {} viewpoints", completed);
+        return completed;
+    }
+
+    void saveCompletedViewpoints(uint32_t completed) const {
+        if (_statePath.empty()) {
+            return;
+        }
+        std::ofstream stream(_statePath, std::ios::trunc);
+        stream << getRegionKey() << '\n' << completed << '\n';
+        if (!stream) {
+            spdlog::default_logger()->warn("Failed to write seeding state to {}", _statePath);
+        }
+    }
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+// The rejection of a request that was cancelled on purpose, e.g. the download of a tile that left
+// the view. It is not a failure of the request, so it is never retried.
+class RequestCancelledError : public std::runtime_error {
+public:
+    explicit RequestCancelledError(const std::string& url) : std::runtime_error("Request cancelled: " + url) {}
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A pool of response body buffers. Buffers handed back by released responses keep their
+// capacity, so a later download of a similar size can be written into an existing
+// allocation instead of growing a fresh vector chunk by chunk.
+class ResponseBufferPool {
+public:
+    // The pool holds at most maxPooledBytes of idle capacity in total, and never keeps a buffer
+    // larger than maxBufferCapacity.
+    ResponseBufferPool(size_t maxPooledBytes = 32 * 1024 * 1024, size_t maxBufferCapacity = 4 * 1024 * 1024)
+        : _maxPooledBytes(maxPooledBytes), _maxBufferCapacity(maxBufferCapacity) {}
+
+    // The largest capacity acquire() reserves up front; larger bodies grow as their bytes arrive.
+    size_t maxBufferCapacity() const {
+        return _maxBufferCapacity;
+    }
+
+    // Returns an empty buffer with at least minCapacity bytes reserved, or maxBufferCapacity()
+    // if minCapacity is larger. The smallest pooled buffer that is large enough is preferred;
+    // a new allocation is only made if none fits.
+    std::vector<uint8_t> acquire(size_t minCapacity = 0) {
+        minCapacity = std::min(minCapacity, _maxBufferCapacity);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto best = _buffers.end();
+            for (auto it = _buffers.begin(); it != _buffers.end(); ++it) {
+                if (it->capacity() >= minCapacity && (best == _buffers.end() || it->capacity() < best->capacity())) {
+                    best = it;
+                }
+            }
+            if (best == _buffers.end() && !_buffers.empty() && minCapacity > 0) {
+                // nothing large enough; take the largest and grow it once below
+                best = std::max_element(_buffers.begin(), _buffers.end(), [](const auto& a, const auto& b) {
+                    return a.capacity() < b.capacity();
+                });
+            }
+            if (best != _buffers.end()) {
+                std::vector<uint8_t> buffer = std::move(*best);
+                _buffers.erase(best);
+                _pooledBytes -= buffer.capacity();
+                buffer.reserve(minCapacity);
+                return buffer;
+            }
+        }
+        std::vector<uint8_t> buffer;
+        buffer.reserve(minCapacity);
+        return buffer;
+    }
+
+    // Returns a buffer to the pool. Oversized buffers and buffers beyond the byte budget are freed.
+    void release(std::vector<uint8_t>&& buffer) {
+        if (buffer.capacity() == 0 || buffer.capacity() > _maxBufferCapacity) {
+            return;
+        }
+        buffer.clear();
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pooledBytes + buffer.capacity() <= _maxPooledBytes) {
+            _pooledBytes += buffer.capacity();
+            _buffers.push_back(std::move(buffer));
+        }
+    }
+
+private:
+    size_t _maxPooledBytes;
+    size_t _maxBufferCapacity;
+    // total capacity of _buffers
+    size_t _pooledBytes = 0;
+    std::mutex _mutex;
+    std::vector<std::vector<uint8_t>> _buffers;
+};
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <locale>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DelayScheduler.hpp"
+#include "FileAssetAccessor.hpp"
+#include "RequestCancelledError.hpp"
+
+struct RetryPolicy {
+    // Number of times a failed request is retried before the failure is passed on.
+    uint32_t maxRetries = 3;
+    // Retry n waits a random time in [0, min(maxDelay, baseDelay * 2^n)] ("full jitter").
+    std::chrono::milliseconds baseDelay { 200 };
+    std::chrono::milliseconds maxDelay { 5000 };
+    // 429 and 503 responses with a Retry-After header are retried after the time the server asks
+    // for instead. If that is longer than this, the response is passed on without retrying.
+    std::chrono::milliseconds maxRetryAfter { 60000 };
+    // Percentile (0-100) of recent request latency after which a duplicate "hedged" request
+    // is sent if the first has not completed. Whichever finishes first is used. 0 disables hedging.
+    double hedgePercentile = 0;
+    // Lower bound for the hedge delay. Cache hits complete almost instantly and would otherwise
+    // drag the percentile down far enough to hedge nearly every network request.
+    std::chrono::milliseconds minHedgeDelay { 50 };
+};
+
+struct RetryStats {
+    uint64_t requests = 0;
+    uint64_t retries = 0;
+    uint64_t hedges = 0;
+    // Hedged requests that completed before the request they were hedging.
+    uint64_t hedgeWins = 0;
+    // Requests that still failed after all retries.
+    uint64_t failures = 0;
+};
+
+// An IAssetAccessor decorator that retries network errors and transient HTTP failures
+// (408, 429, 5xx) of idempotent requests with exponential backoff and jitter, or after the
+// Retry-After time of a 429 or 503 response, and optionally hedges slow GET requests. Cancelled requests
+// (RequestCancelledError) are passed on at once. Backoff and hedge timers run on a
+// DelayScheduler, so no worker thread waits.
+//
+// Hedged requests go to a separate accessor (pHedgeAssetAccessor) so they are not merged
+// into the request they are hedging by a coalescing layer. Local files are never hedged, so
+// pHedgeAssetAccessor only needs to handle network URLs. The losing request is left to
+// finish and its result is discarded.
+class RetryingAssetAccessor : public CesiumAsync::IAssetAccessor, public std::enable_shared_from_this<RetryingAssetAccessor> {
+public:
+    RetryingAssetAccessor(
+        const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor,
+        const std::shared_ptr<CesiumAsync::IAssetAccessor>& pHedgeAssetAccessor,
+        const std::shared_ptr<DelayScheduler>& pDelayScheduler,
+        const RetryPolicy& policy)
+        : _pAssetAccessor(pAssetAccessor),
+          _pHedgeAssetAccessor(pHedgeAssetAccessor),
+          _pDelayScheduler(pDelayScheduler),
+          _policy(policy),
+          _random(std::random_device()()) {}
+
+    RetryStats getStats() const {
+        RetryStats stats;
+        stats.requests = _requests;
+        stats.retries = _retries;
+        stats.hedges = _hedges;
+        stats.hedgeWins = _hedgeWins;
+        stats.failures = _failures;
+        return stats;
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        _requests++;
+        auto pState = std::make_shared<RequestState>(
+            asyncSystem,
+            asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>(),
+            verb,
+            url,
+            headers,
+            std::vector<std::byte>(contentPayload.begin(), contentPayload.end()));
+        auto future = pState->promise.getFuture();
+
+        send(pState, false);
+
+        // local files are not hedged; a second read of the same file would not be any faster
+        if (verb == "GET" && contentPayload.empty() && !FileAssetAccessor::isLocal(url)) {
+            auto hedgeDelay = getHedgeDelay();
+            if (hedgeDelay) {
+                auto pThis = shared_from_this();
+                _pDelayScheduler->schedule(*hedgeDelay, [pThis, pState]() {
+                    if (!pState->settled) {
+                        pThis->_hedges++;
+                        pThis->send(pState, true);
+                    }
+                });
+            }
+        }
+
+        return future;
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    // Shared between every attempt (original, retries and hedge) of one logical request.
+    struct RequestState {
+        CesiumAsync::AsyncSystem asyncSystem;
+        CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>> promise;
+        std::string verb;
+        std::string url;
+        std::vector<THeader> headers;
+        std::vector<std::byte> payload;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::atomic<bool> settled { false };
+        std::atomic<int> outstanding { 0 };
+        std::atomic<uint32_t> retries { 0 };
+
+        RequestState(
+            const CesiumAsync::AsyncSystem& asyncSystem_,
+            CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>>&& promise_,
+            const std::string& verb_,
+            const std::string& url_,
+            const std::vector<THeader>& headers_,
+            std::vector<std::byte>&& payload_)
+            : asyncSystem(asyncSystem_), promise(std::move(promise_)), verb(verb_), url(url_), headers(headers_), payload(std::move(payload_)) {}
+    };
+
+    // Number of recent latencies used to estimate the hedge percentile.
+    static constexpr size_t kLatencySamples = 256;
+    // Hedging only starts once this many latencies have been observed.
+    static constexpr size_t kMinLatencySamples = 20;
+
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pHedgeAssetAccessor;
+    std::shared_ptr<DelayScheduler> _pDelayScheduler;
+    RetryPolicy _policy;
+
+    std::mutex _mutex;
+    std::mt19937 _random;
+    std::vector<double> _latencies;
+    size_t _nextLatency = 0;
+
+    std::atomic<uint64_t> _requests { 0 };
+    std::atomic<uint64_t> _retries { 0 };
+    std::atomic<uint64_t> _hedges { 0 };
+    std::atomic<uint64_t> _hedgeWins { 0 };
+    std::atomic<uint64_t> _failures { 0 };
+
+    void send(const std::shared_ptr<RequestState>& pState, bool isHedge) {
+        pState->outstanding++;
+        auto pThis = shared_from_this();
+        auto& accessor = isHedge ? _pHedgeAssetAccessor : _pAssetAccessor;
+        accessor->request(pState->asyncSystem, pState->verb, pState->url, pState->headers, pState->payload)
+            .thenImmediately([pThis, pState, isHedge](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                pThis->onAttemptComplete(pState, isHedge, std::move(pRequest), nullptr);
+            })
+            .catchImmediately([pThis, pState, isHedge](std::exception&&) {
+                pThis->onAttemptComplete(pState, isHedge, nullptr, std::current_exception());
+            });
+    }
+
+    void onAttemptComplete(
+        const std::shared_ptr<RequestState>& pState,
+        bool isHedge,
+        std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest,
+        std::exception_ptr error) {
+        int outstanding = --pState->outstanding;
+        if (pState->settled) {
+            return;
+        }
+
+        if (error && isCancellation(error)) {
+            // the requester no longer wants the response; a retry would only download it again
+            if (!pState->settled.exchange(true)) {
+                pState->promise.reject(error);
+            }
+            return;
+        }
+
+        if (!error && !isRetryable(*pRequest)) {
+            if (pState->settled.exchange(true)) {
+                return;
+            }
+            recordLatency(std::chrono::steady_clock::now() - pState->start);
+            if (isHedge) {
+                _hedgeWins++;
+            }
+            pState->promise.resolve(std::move(pRequest));
+            return;
+        }
+
+        // another attempt for this request is still running; let it decide
+        if (outstanding > 0) {
+            return;
+        }
+
+        std::optional<std::chrono::milliseconds> retryAfter;
+        if (!error) {
+            retryAfter = getRetryAfter(*pRequest);
+        }
+        uint32_t retry = pState->retries++;
+        if (isIdempotent(pState->verb) && retry < _policy.maxRetries && (!retryAfter || *retryAfter <= _policy.maxRetryAfter)) {
+            _retries++;
+            auto pThis = shared_from_this();
+            _pDelayScheduler->schedule(retryAfter ? *retryAfter : getBackoff(retry), [pThis, pState]() {
+                pThis->send(pState, false);
+            });
+            return;
+        }
+
+        if (pState->settled.exchange(true)) {
+            return;
+        }
+        _failures++;
+        if (error) {
+            pState->promise.reject(error);
+        } else {
+            // pass the final HTTP error response on so the caller can report it
+            pState->promise.resolve(std::move(pRequest));
+        }
+    }
+
+    // Only requests that can safely be sent twice are retried (RFC 9110, section 9.2.2); a failed
+    // POST may still have taken effect on the server.
+    static bool isIdempotent(const std::string& verb) {
+        return verb == "GET" || verb == "HEAD" || verb == "PUT" || verb == "DELETE" || verb == "OPTIONS";
+    }
+
+    static bool isRetryable(const CesiumAsync::IAssetRequest& request) {
+        const CesiumAsync::IAssetResponse* pResponse = request.response();
+        if (!pResponse) {
+            return true;
+        }
+        uint16_t status = pResponse->statusCode();
+        return status == 408 || status == 429 || status == 500 || status == 502 || status == 503 || status == 504;
+    }
+
+    static bool isCancellation(const std::exception_ptr& error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const RequestCancelledError&) {
+            return true;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    // The delay asked for by the Retry-After header of a 429 or 503 response, given either as
+    // seconds or as an HTTP date (RFC 9110, section 10.2.3). Both are clamped to a delay that still
+    // fits in milliseconds, so a far-off value compares as longer than maxRetryAfter instead of
+    // overflowing.
+    static std::optional<std::chrono::milliseconds> getRetryAfter(const CesiumAsync::IAssetRequest& request) {
+        const CesiumAsync::IAssetResponse* pResponse = request.response();
+        if (!pResponse || (pResponse->statusCode() != 429 && pResponse->statusCode() != 503)) {
+            return std::nullopt;
+        }
+        auto it = pResponse->headers().find("Retry-After");
+        if (it == pResponse->headers().end() || it->second.empty()) {
+            return std::nullopt;
+        }
+        const std::string& value = it->second;
+        if (std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            // strtoll saturates at LLONG_MAX
+            return clampedSeconds(std::strtoll(value.c_str(), nullptr, 10));
+        }
+        std::tm date {};
+        std::istringstream stream(value);
+        stream.imbue(std::locale::classic());
+        stream >> std::get_time(&date, "%a, %d %b %Y %H:%M:%S");
+        if (stream.fail()) {
+            return std::nullopt;
+        }
+        // in whole seconds, since a date years ahead does not fit in system_clock's own ticks
+        int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return clampedSeconds(std::max<int64_t>(secondsSinceEpoch(date) - now, 0));
+    }
+
+    static std::chrono::milliseconds clampedSeconds(long long seconds) {
+        constexpr long long kMaxSeconds = std::chrono::milliseconds::max().count() / 1000;
+        return std::chrono::milliseconds(std::min(seconds, kMaxSeconds) * 1000);
+    }
+
+    // timegm() is not portable; converts a UTC calendar date to seconds since 1970 directly.
+    static int64_t secondsSinceEpoch(const std::tm& date) {
+        int64_t year = date.tm_year + 1900;
+        int64_t month = date.tm_mon + 1;
+        year -= month <= 2;
+        int64_t era = (year >= 0 ? year : year - 399) / 400;
+        int64_t yearOfEra = year - era * 400;
+        int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + date.tm_mday - 1;
+        int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        int64_t days = era * 146097 + dayOfEra - 719468;
+        return days * 86400 + date.tm_hour * 3600 + date.tm_min * 60 + date.tm_sec;
+    }
+
+    std::chrono::milliseconds getBackoff(uint32_t retry) {
+        double ceiling = std::min(
+            static_cast<double>(_policy.maxDelay.count()),
+            static_cast<double>(_policy.baseDelay.count()) * static_cast<double>(1u << std::min(retry, 16u)));
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::uniform_real_distribution<double> jitter(0.0, ceiling);
+        return std::chrono::milliseconds(static_cast<int64_t>(jitter(_random)));
+    }
+
+    void recordLatency(std::chrono::steady_clock::duration latency) {
+        if (_policy.hedgePercentile <= 0) {
+            return;
+        }
+        double ms = std::chrono::duration<double, std::milli>(latency).count();
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_latencies.size() < kLatencySamples) {
+            _latencies.push_back(ms);
+        } else {
+            _latencies[_nextLatency] = ms;
+            _nextLatency = (_nextLatency + 1) % kLatencySamples;
+        }
+    }
+
+    std::optional<std::chrono::milliseconds> getHedgeDelay() {
+        if (_policy.hedgePercentile <= 0) {
+            return std::nullopt;
+        }
+        std::vector<double> latencies;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_latencies.size() < kMinLatencySamples) {
+                return std::nullopt;
+            }
+            latencies = _latencies;
+        }
+        double percentile = std::min(_policy.hedgePercentile, 100.0) / 100.0;
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(percentile * static_cast<double>(latencies.size())));
+        std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(index), latencies.end());
+        return std::max(_policy.minHedgeDelay, std::chrono::milliseconds(static_cast<int64_t>(latencies[index])));
+    }
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "WriteBehindSqliteCache.hpp"
+
+struct RevalidationStats {
+    // Conditional requests sent for stale cache entries.
+    uint64_t revalidations = 0;
+    // Revalidations answered with 304 Not Modified.
+    uint64_t notModified = 0;
+    // Body bytes that did not have to be downloaded again thanks to a 304.
+    uint64_t bytesSaved = 0;
+};
+
+// An IAssetAccessor decorator that sits directly below CachingAssetAccessor and counts its
+// revalidations. CachingAssetAccessor refetches a stale entry with the entry's ETag and
+// Last-Modified validators as If-None-Match / If-Modified-Since and handles a 304 Not Modified
+// answer itself; this layer only observes those requests. The bytes saved by a 304 are the size of
+// the stored body, read from the cache's size column rather than by loading the body.
+class RevalidatingAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    RevalidatingAssetAccessor(
+        const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor,
+        const std::shared_ptr<WriteBehindSqliteCache>& pCache)
+        : _pAssetAccessor(pAssetAccessor), _pCache(pCache) {}
+
+    RevalidationStats getStats() const {
+        RevalidationStats stats;
+        stats.revalidations = _revalidations;
+        stats.notModified = _notModified;
+        stats.bytesSaved = _bytesSaved;
+        return stats;
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        if (verb != "GET" || !contentPayload.empty() || !hasValidators(headers)) {
+            return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        }
+
+        _revalidations++;
+        // the size lookup is a SQLite query; keep it off libcurl's I/O thread
+        return _pAssetAccessor->request(asyncSystem, verb, url, headers)
+            .thenInWorkerThread([this, url](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+                if (pResponse && pResponse->statusCode() == 304) {
+                    _notModified++;
+                    // CachingAssetAccessor keys entries by URL
+                    std::optional<uint64_t> size = _pCache->getEntrySize(url);
+                    if (!size) {
+                        auto contentLength = pResponse->headers().find("Content-Length");
+                        if (contentLength != pResponse->headers().end()) {
+                            size = std::strtoull(contentLength->second.c_str(), nullptr, 10);
+                        }
+                    }
+                    _bytesSaved += size.value_or(0);
+                }
+                return std::move(pRequest);
+            });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    std::shared_ptr<WriteBehindSqliteCache> _pCache;
+    std::atomic<uint64_t> _revalidations { 0 };
+    std::atomic<uint64_t> _notModified { 0 };
+    std::atomic<uint64_t> _bytesSaved { 0 };
+
+    static bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    static bool hasValidators(const std::vector<THeader>& headers) {
+        for (const auto& header : headers) {
+            if (equalsIgnoreCase(header.first, "If-None-Match") || equalsIgnoreCase(header.first, "If-Modified-Since")) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
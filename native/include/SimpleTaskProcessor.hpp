@@ -0,0 +1,67 @@
+#pragma once
+
+#include <CesiumAsync/ITaskProcessor.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A thread pool with a single locked FIFO queue. Replaced by WorkStealingTaskProcessor and kept
+// as the baseline of native/task_processor_benchmark.cpp.
+class SimpleTaskProcessor : public CesiumAsync::ITaskProcessor {
+public:
+    SimpleTaskProcessor(size_t numThreads) : running(true) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            workerThreads.emplace_back(&SimpleTaskProcessor::processJobs, this);
+        }
+    }
+
+    ~SimpleTaskProcessor() {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            running = false;
+            condition.notify_all();
+        }
+        for (auto& thread : workerThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    virtual void startTask(std::function<void()> f) override {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        jobQueue.push(std::move(f));
+        condition.notify_one();
+    }
+
+private:
+    void processJobs() {
+        while (running) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                condition.wait(lock, [this] { return !jobQueue.empty() || !running; });
+                if (!running && jobQueue.empty()) {
+                    return;
+                }
+                if (!jobQueue.empty()) {
+                    job = std::move(jobQueue.front());
+                    jobQueue.pop();
+                }
+            }
+            if (job) {
+                job();
+            }
+        }
+    }
+
+    std::queue<std::function<void()>> jobQueue;
+    std::mutex queueMutex;
+    std::condition_variable condition;
+    std::vector<std::thread> workerThreads;
+    std::atomic<bool> running;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+// Scheduling classes of WorkStealingTaskProcessor, most urgent first.
+enum class TaskPriority {
+    // Work the user is waiting for right now, e.g. loading a tileset's root.
+    Urgent,
+    // Loading the tiles of the current view.
+    Normal,
+    // Work whose result is not on screen, e.g. serializing models for the app.
+    Background,
+    // Speculative loads, e.g. seeding a region into the cache.
+    Prefetch,
+};
+
+constexpr size_t kTaskPriorityCount = 4;
+
+namespace TaskPriorityDetail {
+inline thread_local TaskPriority current = TaskPriority::Normal;
+}
+
+// The priority given to tasks started by this thread. Inside a task it is the task's own
+// priority, so continuations inherit the priority of the work that spawned them.
+inline TaskPriority getCurrentTaskPriority() {
+    return TaskPriorityDetail::current;
+}
+
+// Sets the current thread's task priority until the scope ends.
+class TaskPriorityScope {
+public:
+    explicit TaskPriorityScope(TaskPriority priority) : _previous(TaskPriorityDetail::current) {
+        TaskPriorityDetail::current = priority;
+    }
+
+    ~TaskPriorityScope() {
+        TaskPriorityDetail::current = _previous;
+    }
+
+    TaskPriorityScope(const TaskPriorityScope&) = delete;
+    TaskPriorityScope& operator=(const TaskPriorityScope&) = delete;
+
+private:
+    TaskPriority _previous;
+};
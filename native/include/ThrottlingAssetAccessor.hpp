@@ -0,0 +1,433 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/IAssetResponse.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "RequestCancelledError.hpp"
+
+// Request and bandwidth limits for a token bucket. A rate of 0 means unlimited.
+struct ThrottleLimits {
+    double bytesPerSecond = 0;
+    double requestsPerSecond = 0;
+};
+
+// An IAssetAccessor decorator that rate-limits requests to the wrapped accessor with token buckets,
+// one per host plus one global bucket. A request is only forwarded once both its host bucket and the
+// global bucket have a request token and a positive byte balance. Response sizes are not known up
+// front, so each request is charged an estimate when it is sent (the running mean response size of
+// its host) and the difference is settled when the response arrives. A burst of requests therefore
+// goes out at the byte rate instead of all at once, followed by a stall while the debt is paid back.
+// The buckets only decide when a request is sent; pacing the transfer itself is up to the wrapped
+// accessor, which can hold each transfer to getTransferByteRate() and re-apply it whenever a
+// transfer starts or finishes (CurlAssetAccessor does).
+//
+// Requests waiting for tokens are held by a dispatcher thread, so no worker thread is blocked.
+// Requests to a throttled host do not hold up requests to other hosts.
+class ThrottlingAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+    ThrottlingAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor)
+        : _pAssetAccessor(pAssetAccessor) {
+        _dispatcher = std::thread(&ThrottlingAssetAccessor::dispatchRequests, this);
+    }
+
+    ~ThrottlingAssetAccessor() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _condition.notify_all();
+        if (_dispatcher.joinable()) {
+            _dispatcher.join();
+        }
+        for (auto& pending : _pending) {
+            pending.promise.reject(std::runtime_error("ThrottlingAssetAccessor destroyed before request was sent"));
+        }
+    }
+
+    // Sets the limits shared by all hosts.
+    void setGlobalLimits(const ThrottleLimits& limits) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _global.setLimits(limits);
+        updateThrottling();
+        _condition.notify_all();
+    }
+
+    // Sets the limits for a single host, e.g. "tile.googleapis.com".
+    void setHostLimits(const std::string& host, const ThrottleLimits& limits) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _hostLimits[host] = limits;
+        auto it = _hosts.find(host);
+        if (it != _hosts.end()) {
+            it->second.setLimits(limits);
+        }
+        updateThrottling();
+        _condition.notify_all();
+    }
+
+    // Sets the limits applied to every host without host-specific limits.
+    void setDefaultHostLimits(const ThrottleLimits& limits) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _defaultHostLimits = limits;
+        for (auto& [host, bucket] : _hosts) {
+            if (_hostLimits.find(host) == _hostLimits.end()) {
+                bucket.setLimits(limits);
+            }
+        }
+        updateThrottling();
+        _condition.notify_all();
+    }
+
+    // The receive rate, in bytes per second, that a transfer to url should currently be held to so
+    // that it does not burst at line rate: the byte rates of its host and of all hosts, each split
+    // evenly between the transfers in flight under it. 0 means unlimited. The split changes with
+    // every transfer sent or completed, so the rate of a running transfer has to be re-read then;
+    // otherwise transfers sent in a burst get r, r/2, r/3, ... and together exceed r.
+    double getTransferByteRate(const std::string& url) {
+        if (!_throttling) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        double rate = _global.transferByteRate();
+        auto it = _hosts.find(getHost(url));
+        if (it != _hosts.end()) {
+            double hostRate = it->second.transferByteRate();
+            if (hostRate > 0 && (rate <= 0 || hostRate < rate)) {
+                rate = hostRate;
+            }
+        }
+        return rate;
+    }
+
+    // Rejects every request still waiting for tokens whose URL matches the predicate with
+    // RequestCancelledError. Requests that have already been sent are not affected.
+    void cancelRequests(const std::function<bool(const std::string& url)>& predicate) {
+        std::vector<PendingRequest> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto it = _pending.begin(); it != _pending.end();) {
+                if (predicate(it->url)) {
+                    cancelled.push_back(std::move(*it));
+                    it = _pending.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (auto& pending : cancelled) {
+            pending.promise.reject(RequestCancelledError(pending.url));
+        }
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        // with no limits configured, skip the hop through the dispatcher thread
+        if (!_throttling) {
+            return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload);
+        }
+
+        auto promise = asyncSystem.createPromise<std::shared_ptr<CesiumAsync::IAssetRequest>>();
+        auto future = promise.getFuture();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _pending.push_back(PendingRequest {
+                asyncSystem,
+                promise,
+                verb,
+                url,
+                headers,
+                std::vector<std::byte>(contentPayload.begin(), contentPayload.end()),
+                getHost(url)
+            });
+        }
+        _condition.notify_all();
+        return future;
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+    // Extracts the host (without port) from a URL of the form scheme://[user@]host[:port]/path.
+    static std::string getHost(const std::string& url) {
+        size_t start = url.find("://");
+        start = start == std::string::npos ? 0 : start + 3;
+        size_t end = url.find_first_of("/?#", start);
+        std::string authority = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        size_t at = authority.rfind('@');
+        if (at != std::string::npos) {
+            authority = authority.substr(at + 1);
+        }
+        if (!authority.empty() && authority[0] == '[') {
+            // IPv6 literal
+            return authority.substr(0, authority.find(']') + 1);
+        }
+        return authority.substr(0, authority.find(':'));
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    class TokenBucket {
+    public:
+        void setLimits(const ThrottleLimits& limits) {
+            _limits = limits;
+            _requestTokens = std::min(_requestTokens, burst(limits.requestsPerSecond));
+            _byteTokens = std::min(_byteTokens, burst(limits.bytesPerSecond));
+        }
+
+        const ThrottleLimits& getLimits() const {
+            return _limits;
+        }
+
+        void refill(Clock::time_point now) {
+            double elapsed = std::chrono::duration<double>(now - _lastRefill).count();
+            _lastRefill = now;
+            if (_limits.requestsPerSecond > 0) {
+                _requestTokens = std::min(_requestTokens + elapsed * _limits.requestsPerSecond, burst(_limits.requestsPerSecond));
+            }
+            if (_limits.bytesPerSecond > 0) {
+                _byteTokens = std::min(_byteTokens + elapsed * _limits.bytesPerSecond, burst(_limits.bytesPerSecond));
+            }
+        }
+
+        bool canSend() const {
+            return (_limits.requestsPerSecond <= 0 || _requestTokens >= 1.0) &&
+                   (_limits.bytesPerSecond <= 0 || _byteTokens > 0);
+        }
+
+        void consumeRequest() {
+            if (_limits.requestsPerSecond > 0) {
+                _requestTokens -= 1.0;
+            }
+        }
+
+        void consumeBytes(double bytes) {
+            if (_limits.bytesPerSecond > 0) {
+                _byteTokens -= bytes;
+            }
+        }
+
+        // The expected size of the next response, charged when a request is sent.
+        double estimateResponseBytes() const {
+            return _meanResponseBytes;
+        }
+
+        void addTransfers(int count) {
+            _transfersInFlight += count;
+        }
+
+        // The byte rate split evenly between the transfers in flight; 0 means unlimited.
+        double transferByteRate() const {
+            return _limits.bytesPerSecond / static_cast<double>(std::max(_transfersInFlight, 1));
+        }
+
+        void recordResponseBytes(size_t bytes) {
+            _meanResponseBytes += (static_cast<double>(bytes) - _meanResponseBytes) * kResponseBytesWeight;
+        }
+
+        // Seconds until canSend() becomes true, assuming no other consumption.
+        double secondsUntilReady() const {
+            double wait = 0;
+            if (_limits.requestsPerSecond > 0 && _requestTokens < 1.0) {
+                wait = std::max(wait, (1.0 - _requestTokens) / _limits.requestsPerSecond);
+            }
+            if (_limits.bytesPerSecond > 0 && _byteTokens <= 0) {
+                wait = std::max(wait, (1.0 - _byteTokens) / _limits.bytesPerSecond);
+            }
+            return wait;
+        }
+
+    private:
+        // weight of the latest response in the running mean
+        static constexpr double kResponseBytesWeight = 0.1;
+
+        // buckets hold at most one second worth of tokens
+        static double burst(double rate) {
+            return rate > 0 ? std::max(rate, 1.0) : 0;
+        }
+
+        ThrottleLimits _limits;
+        double _requestTokens = 1.0;
+        double _byteTokens = 1.0;
+        // a typical tile until responses have been seen
+        double _meanResponseBytes = 64 * 1024;
+        // requests sent and not yet answered
+        int _transfersInFlight = 0;
+        Clock::time_point _lastRefill = Clock::now();
+    };
+
+    struct PendingRequest {
+        CesiumAsync::AsyncSystem asyncSystem;
+        CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>> promise;
+        std::string verb;
+        std::string url;
+        std::vector<THeader> headers;
+        std::vector<std::byte> payload;
+        std::string host;
+        // bytes charged when the request was sent
+        double estimatedBytes = 0;
+    };
+
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::thread _dispatcher;
+    bool _running = true;
+    std::atomic<bool> _throttling { false };
+
+    std::deque<PendingRequest> _pending;
+    TokenBucket _global;
+    ThrottleLimits _defaultHostLimits;
+    std::unordered_map<std::string, ThrottleLimits> _hostLimits;
+    std::unordered_map<std::string, TokenBucket> _hosts;
+
+    static bool isLimited(const ThrottleLimits& limits) {
+        return limits.bytesPerSecond > 0 || limits.requestsPerSecond > 0;
+    }
+
+    // Must be called with _mutex held.
+    void updateThrottling() {
+        bool throttling = isLimited(_global.getLimits()) || isLimited(_defaultHostLimits);
+        for (const auto& [host, limits] : _hostLimits) {
+            throttling = throttling || isLimited(limits);
+        }
+        _throttling = throttling;
+    }
+
+    TokenBucket& getBucket(const std::string& host) {
+        auto it = _hosts.find(host);
+        if (it == _hosts.end()) {
+            auto limits = _hostLimits.find(host);
+            it = _hosts.emplace(host, TokenBucket()).first;
+            it->second.setLimits(limits == _hostLimits.end() ? _defaultHostLimits : limits->second);
+        }
+        return it->second;
+    }
+
+    void dispatchRequests() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (_running) {
+            auto now = Clock::now();
+            _global.refill(now);
+            for (auto& [host, bucket] : _hosts) {
+                bucket.refill(now);
+            }
+
+            std::vector<PendingRequest> ready;
+            double wait = -1;
+            for (auto it = _pending.begin(); it != _pending.end();) {
+                TokenBucket& hostBucket = getBucket(it->host);
+                if (_global.canSend() && hostBucket.canSend()) {
+                    _global.consumeRequest();
+                    hostBucket.consumeRequest();
+                    it->estimatedBytes = hostBucket.estimateResponseBytes();
+                    _global.consumeBytes(it->estimatedBytes);
+                    hostBucket.consumeBytes(it->estimatedBytes);
+                    ready.push_back(std::move(*it));
+                    it = _pending.erase(it);
+                } else {
+                    double hostWait = std::max(_global.secondsUntilReady(), hostBucket.secondsUntilReady());
+                    wait = wait < 0 ? hostWait : std::min(wait, hostWait);
+                    ++it;
+                }
+            }
+
+            if (!ready.empty()) {
+                // forward outside the lock; the wrapped accessor may complete inline
+                lock.unlock();
+                for (auto& pending : ready) {
+                    send(std::move(pending));
+                }
+                lock.lock();
+                continue;
+            }
+
+            if (wait < 0) {
+                _condition.wait(lock);
+            } else {
+                _condition.wait_for(lock, std::chrono::duration<double>(std::max(wait, 0.001)));
+            }
+        }
+    }
+
+    void send(PendingRequest&& pending) {
+        auto promise = pending.promise;
+        std::string host = pending.host;
+        double estimatedBytes = pending.estimatedBytes;
+        {
+            // counted before the request is made, so that getTransferByteRate() includes it
+            std::lock_guard<std::mutex> lock(_mutex);
+            _global.addTransfers(1);
+            getBucket(host).addTransfers(1);
+        }
+        std::optional<CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>> future;
+        try {
+            future.emplace(_pAssetAccessor->request(pending.asyncSystem, pending.verb, pending.url, pending.headers, pending.payload));
+        } catch (...) {
+            // thrown on the dispatcher thread; fail this request only, as if the transfer had failed
+            refundTransfer(host, estimatedBytes);
+            promise.reject(std::current_exception());
+            return;
+        }
+        std::move(*future)
+            .thenImmediately([this, promise, host, estimatedBytes](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+                size_t bytes = pResponse ? pResponse->data().size() : 0;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    // settle the estimate charged at dispatch against the actual size
+                    TokenBucket& hostBucket = getBucket(host);
+                    _global.addTransfers(-1);
+                    hostBucket.addTransfers(-1);
+                    _global.consumeBytes(static_cast<double>(bytes) - estimatedBytes);
+                    hostBucket.consumeBytes(static_cast<double>(bytes) - estimatedBytes);
+                    if (pResponse) {
+                        hostBucket.recordResponseBytes(bytes);
+                    }
+                }
+                promise.resolve(std::move(pRequest));
+            })
+            .catchImmediately([this, promise, host, estimatedBytes](std::exception&&) {
+                refundTransfer(host, estimatedBytes);
+                promise.reject(std::current_exception());
+            });
+    }
+
+    // Ends a transfer that received nothing, refunding the estimate charged at dispatch.
+    void refundTransfer(const std::string& host, double estimatedBytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        TokenBucket& hostBucket = getBucket(host);
+        _global.addTransfers(-1);
+        hostBucket.addTransfers(-1);
+        _global.consumeBytes(-estimatedBytes);
+        hostBucket.consumeBytes(-estimatedBytes);
+    }
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <CesiumAsync/IAssetAccessor.h>
+#include <CesiumAsync/IAssetRequest.h>
+#include <CesiumAsync/AsyncSystem.h>
+#include <CesiumUtility/Uri.h>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A per-tileset IAssetAccessor decorator that keeps track of the URLs the tileset currently has in
+// flight and of the tileset JSON files it has loaded. Tile content URIs are relative to the
+// tileset JSON (root or external) that contains them, so findInFlightUrls() can map the content
+// URIs of tiles back to the exact requests this tileset made for them.
+class TilesetRequestTracker : public CesiumAsync::IAssetAccessor {
+public:
+    TilesetRequestTracker(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor)
+        : _pAssetAccessor(pAssetAccessor) {}
+
+    // Returns the URLs this tileset has in flight for the given tile content URIs. Each URI is
+    // resolved the way the tileset loader resolves it: against a tileset JSON URL, keeping that
+    // URL's query parameters.
+    std::vector<std::string> findInFlightUrls(const std::vector<std::string>& contentUris) const {
+        std::vector<std::string> urls;
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& contentUri : contentUris) {
+            for (const auto& tilesetUrl : _tilesetUrls) {
+                std::string url = CesiumUtility::Uri::resolve(tilesetUrl, contentUri, true);
+                if (_inFlight.count(url)) {
+                    urls.push_back(std::move(url));
+                    break;
+                }
+            }
+        }
+        return urls;
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> get(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& url,
+        const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) override {
+        return request(asyncSystem, "GET", url, headers);
+    }
+
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> request(
+        const CesiumAsync::AsyncSystem& asyncSystem,
+        const std::string& verb,
+        const std::string& url,
+        const std::vector<THeader>& headers,
+        const gsl::span<const std::byte>& contentPayload = {}) override {
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _inFlight[url]++;
+            if (isTilesetJson(url)) {
+                _tilesetUrls.insert(url);
+            }
+        }
+        return _pAssetAccessor->request(asyncSystem, verb, url, headers, contentPayload)
+            .thenImmediately([this, url](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+                finish(url);
+                return std::move(pRequest);
+            })
+            .catchImmediately([this, url](std::exception&&) -> std::shared_ptr<CesiumAsync::IAssetRequest> {
+                finish(url);
+                std::rethrow_exception(std::current_exception());
+            });
+    }
+
+    void tick() noexcept override {
+        _pAssetAccessor->tick();
+    }
+
+private:
+    std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+    mutable std::mutex _mutex;
+    // number of requests in flight for each URL
+    std::unordered_map<std::string, int> _inFlight;
+    // root and external tileset JSON URLs, the bases of content URIs
+    std::set<std::string> _tilesetUrls;
+
+    void finish(const std::string& url) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _inFlight.find(url);
+        if (it != _inFlight.end() && --it->second == 0) {
+            _inFlight.erase(it);
+        }
+    }
+
+    static bool isTilesetJson(const std::string& url) {
+        std::string path = url.substr(0, url.find_first_of("?#"));
+        return path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    }
+};
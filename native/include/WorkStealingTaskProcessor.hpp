@@ -0,0 +1,318 @@
+#pragma once
+
+#include <CesiumAsync/ITaskProcessor.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TaskPriority.hpp"
+
+// A lock-free single-owner deque (Chase & Lev, "Dynamic Circular Work-Stealing Deque", with the
+// memory orderings of Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+// The owning thread pushes and pops at the bottom; any other thread may steal from the top.
+// Arrays replaced by a resize are kept until destruction, since a thief may still be reading one.
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        _arrays.push_back(std::make_unique<Array>(capacity));
+        _pArray.store(_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only.
+    void push(T* pItem) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_acquire);
+        Array* pArray = _pArray.load(std::memory_order_relaxed);
+        if (bottom - top > pArray->capacity - 1) {
+            pArray = grow(pArray, bottom, top);
+        }
+        pArray->put(bottom, pItem);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only. Returns nullptr if the deque is empty.
+    T* pop() {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        Array* pArray = _pArray.load(std::memory_order_relaxed);
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = _top.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* pItem = pArray->get(bottom);
+        if (top == bottom) {
+            // the last item; race the thieves for it
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                pItem = nullptr;
+            }
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return pItem;
+    }
+
+    // Any thread. Returns nullptr if the deque is empty or another thread won the race.
+    T* steal() {
+        int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = _bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        Array* pArray = _pArray.load(std::memory_order_acquire);
+        T* pItem = pArray->get(top);
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return pItem;
+    }
+
+    bool empty() const {
+        return _top.load(std::memory_order_relaxed) >= _bottom.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Array {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T*>[]> items;
+
+        explicit Array(int64_t capacity) : capacity(capacity), items(new std::atomic<T*>[static_cast<size_t>(capacity)]) {}
+
+        T* get(int64_t index) const {
+            return items[static_cast<size_t>(index & (capacity - 1))].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T* pItem) {
+            items[static_cast<size_t>(index & (capacity - 1))].store(pItem, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> _top { 0 };
+    alignas(64) std::atomic<int64_t> _bottom { 0 };
+    std::atomic<Array*> _pArray;
+    // owner only; index 0 is the initial array
+    std::vector<std::unique_ptr<Array>> _arrays;
+
+    Array* grow(Array* pArray, int64_t bottom, int64_t top) {
+        auto pGrown = std::make_unique<Array>(pArray->capacity * 2);
+        for (int64_t i = top; i < bottom; i++) {
+            pGrown->put(i, pArray->get(i));
+        }
+        Array* pResult = pGrown.get();
+        _arrays.push_back(std::move(pGrown));
+        _pArray.store(pResult, std::memory_order_release);
+        return pResult;
+    }
+};
+
+// An ITaskProcessor with work-stealing deques per worker thread, one for each TaskPriority class.
+// Tasks started from a worker (continuations of a task, which are most of them) go to the bottom
+// of that worker's own deque without any lock. Tasks started from other threads (the main thread,
+// libcurl's I/O thread) are spread round-robin over small per-worker inboxes, so submitters rarely
+// contend on a lock. An idle worker first drains its own deque and inbox, then steals from the
+// others, and only blocks once all of them are empty. Submitters only touch the condition variable
+// when a worker is actually asleep.
+//
+// A task is queued in the class of getCurrentTaskPriority() on the starting thread and runs with
+// that priority as the current one, so its continuations inherit it. Workers take the most urgent
+// class with queued tasks, except that a class not served for longer than its aging limit is taken
+// first, so a stream of tile loads cannot starve background work indefinitely.
+class WorkStealingTaskProcessor : public CesiumAsync::ITaskProcessor {
+public:
+    explicit WorkStealingTaskProcessor(size_t numThreads) {
+        numThreads = std::max<size_t>(numThreads, 1);
+        for (size_t i = 0; i < numThreads; i++) {
+            _workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < numThreads; i++) {
+            _workers[i]->thread = std::thread([this, i]() { run(i); });
+        }
+    }
+
+    ~WorkStealingTaskProcessor() {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _running = false;
+        }
+        _sleepCondition.notify_all();
+        for (auto& pWorker : _workers) {
+            pWorker->thread.join();
+        }
+        // tasks still queued are dropped, as they would be by a stopped thread pool
+        for (auto& pWorker : _workers) {
+            for (Queue& queue : pWorker->queues) {
+                while (Task* pTask = queue.deque.pop()) {
+                    delete pTask;
+                }
+                for (Task* pTask : queue.inbox) {
+                    delete pTask;
+                }
+            }
+        }
+    }
+
+    void startTask(std::function<void()> f) override {
+        TaskPriority priority = getCurrentTaskPriority();
+        size_t priorityIndex = static_cast<size_t>(priority);
+        Task* pTask = new Task { std::move(f), priority };
+        PriorityClass& priorityClass = _classes[priorityIndex];
+        if (priorityClass.queued.fetch_add(1, std::memory_order_relaxed) == 0) {
+            // the class waits from now on, not since it was last served
+            priorityClass.lastServed.store(now(), std::memory_order_relaxed);
+        }
+        _queued.fetch_add(1, std::memory_order_seq_cst);
+        if (tlsProcessor == this) {
+            _workers[tlsWorkerIndex]->queues[priorityIndex].deque.push(pTask);
+        } else {
+            Queue& queue = _workers[_nextInbox.fetch_add(1, std::memory_order_relaxed) % _workers.size()]->queues[priorityIndex];
+            std::lock_guard<std::mutex> lock(queue.inboxMutex);
+            queue.inbox.push_back(pTask);
+        }
+        if (_sleeping.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _sleepCondition.notify_one();
+        }
+    }
+
+private:
+    struct Task {
+        std::function<void()> function;
+        TaskPriority priority;
+    };
+
+    struct Queue {
+        WorkStealingDeque<Task> deque;
+        std::mutex inboxMutex;
+        std::deque<Task*> inbox;
+    };
+
+    struct Worker {
+        std::array<Queue, kTaskPriorityCount> queues;
+        std::thread thread;
+    };
+
+    struct PriorityClass {
+        // tasks of this class started but not yet taken by a worker
+        std::atomic<int64_t> queued { 0 };
+        // steady clock nanoseconds
+        std::atomic<int64_t> lastServed { 0 };
+    };
+
+    static constexpr int kSpinsBeforeSleep = 64;
+    // How long a class with queued tasks may go unserved before it is taken ahead of more urgent ones.
+    static constexpr std::array<std::chrono::milliseconds, kTaskPriorityCount> kAgingLimits {
+        std::chrono::milliseconds(0),
+        std::chrono::milliseconds(100),
+        std::chrono::milliseconds(250),
+        std::chrono::milliseconds(1000)
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::array<PriorityClass, kTaskPriorityCount> _classes;
+    std::atomic<size_t> _nextInbox { 0 };
+    // tasks started but not yet taken by a worker
+    std::atomic<int64_t> _queued { 0 };
+    std::atomic<int> _sleeping { 0 };
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    std::atomic<bool> _running { true };
+
+    static inline thread_local WorkStealingTaskProcessor* tlsProcessor = nullptr;
+    static inline thread_local size_t tlsWorkerIndex = 0;
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void run(size_t index) {
+        tlsProcessor = this;
+        tlsWorkerIndex = index;
+        int spins = 0;
+        while (_running.load(std::memory_order_relaxed)) {
+            if (Task* pTask = take(index)) {
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                std::unique_ptr<Task> task(pTask);
+                TaskPriorityScope scope(task->priority);
+                task->function();
+                spins = 0;
+                continue;
+            }
+            if (++spins < kSpinsBeforeSleep) {
+                std::this_thread::yield();
+                continue;
+            }
+            spins = 0;
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _sleeping.fetch_add(1, std::memory_order_seq_cst);
+            _sleepCondition.wait(lock, [this]() {
+                return !_running || _queued.load(std::memory_order_seq_cst) > 0;
+            });
+            _sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    Task* take(size_t index) {
+        int64_t time = now();
+        for (size_t priority = 1; priority < kTaskPriorityCount; priority++) {
+            const PriorityClass& priorityClass = _classes[priority];
+            int64_t waited = time - priorityClass.lastServed.load(std::memory_order_relaxed);
+            if (priorityClass.queued.load(std::memory_order_relaxed) > 0 &&
+                waited > std::chrono::duration_cast<std::chrono::nanoseconds>(kAgingLimits[priority]).count()) {
+                if (Task* pTask = take(index, priority, time)) {
+                    return pTask;
+                }
+            }
+        }
+        for (size_t priority = 0; priority < kTaskPriorityCount; priority++) {
+            if (_classes[priority].queued.load(std::memory_order_relaxed) > 0) {
+                if (Task* pTask = take(index, priority, time)) {
+                    return pTask;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    Task* take(size_t index, size_t priority, int64_t time) {
+        Task* pTask = nullptr;
+        Queue& own = _workers[index]->queues[priority];
+        if (!(pTask = own.deque.pop()) && !(pTask = popInbox(own))) {
+            for (size_t i = 1; i < _workers.size() && !pTask; i++) {
+                Queue& victim = _workers[(index + i) % _workers.size()]->queues[priority];
+                if (!(pTask = victim.deque.steal())) {
+                    pTask = popInbox(victim);
+                }
+            }
+        }
+        if (pTask) {
+            _classes[priority].queued.fetch_sub(1, std::memory_order_relaxed);
+            _classes[priority].lastServed.store(time, std::memory_order_relaxed);
+        }
+        return pTask;
+    }
+
+    static Task* popInbox(Queue& queue) {
+        std::unique_lock<std::mutex> lock(queue.inboxMutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.inbox.empty()) {
+            return nullptr;
+        }
+        Task* pTask = queue.inbox.front();
+        queue.inbox.pop_front();
+        return pTask;
+    }
+};
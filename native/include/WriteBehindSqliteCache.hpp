@@ -0,0 +1,837 @@
+#pragma once
+
+#include <CesiumAsync/ICacheDatabase.h>
+#include <CesiumAsync/CacheItem.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <openssl/evp.h>
+#include <rapidjson/document.h>
+#include <sqlite3.h>
+#include <spdlog/spdlog.h>
+
+#include "FileAssetAccessor.hpp"
+#include "NetworkTimingStats.hpp"
+
+// Which entries prune() removes first once the cache is over budget. Expired entries are always
+// removed. Pinned entries (see WriteBehindSqliteCache::pin) are never removed by prune().
+enum class CachePrunePolicy {
+    // The entries that were not read for the longest time.
+    LeastRecentlyUsed,
+    // The entries that will expire soonest, then the ones not read for the longest time.
+    ExpiryFirst,
+};
+
+struct WriteBehindSqliteCacheOptions {
+    // Maximum number of unpinned entries kept by prune(); 0 means unlimited.
+    uint64_t maxItems = 4096;
+    // Maximum total size of the unpinned response bodies kept by prune(); 0 means unlimited.
+    uint64_t maxBytes = 0;
+    CachePrunePolicy policy = CachePrunePolicy::LeastRecentlyUsed;
+    // Pending stores are committed at least this often.
+    std::chrono::milliseconds flushInterval { 250 };
+    // Pending stores are committed early once their bodies add up to this many bytes.
+    size_t flushBytes = 8 * 1024 * 1024;
+    // If set, response bodies are written to this directory as files named by the SHA-256 of their
+    // contents and only the metadata is kept in SQLite. Hits are read by memory-mapping the file.
+    std::string blobDirectory;
+};
+
+// Counters of a WriteBehindSqliteCache. Lookups answered from the write queue count as hits.
+struct SqliteCacheStats {
+    std::atomic<uint64_t> hits { 0 };
+    std::atomic<uint64_t> misses { 0 };
+    std::atomic<uint64_t> prunes { 0 };
+    std::atomic<uint64_t> prunedEntries { 0 };
+    // Duration of getEntry(), in microseconds.
+    Histogram lookupTime;
+    // Duration of a prune, in microseconds.
+    Histogram pruneTime;
+    // Duration of a batched commit, in microseconds.
+    Histogram commitTime;
+};
+
+// The current contents of a WriteBehindSqliteCache.
+struct SqliteCacheUsage {
+    uint64_t entries = 0;
+    // Total size of the stored response bodies. In blob mode identical bodies are counted once per
+    // entry although they share a file.
+    uint64_t bytes = 0;
+    // Entries not yet committed to the database.
+    uint64_t pendingEntries = 0;
+};
+
+// An ICacheDatabase backed by SQLite in WAL mode that does not write on the calling thread.
+// storeEntry() only queues the entry; a dedicated writer thread commits everything queued in a
+// single transaction every flushInterval, or sooner once flushBytes have accumulated. Queued
+// entries are already visible to getEntry(), so a tile stored a moment ago is still a cache hit.
+//
+// In blob mode (see WriteBehindSqliteCacheOptions::blobDirectory) identical bodies share one file,
+// which is unlinked by prune() or a replacing store once no entry refers to it any more. Keeping
+// multi-megabyte bodies out of the database keeps it small and pruning fast.
+//
+// Reads use their own connection, which WAL lets run concurrently with a commit in progress.
+// Entries still queued when the cache is destroyed are committed first; call flush() to commit
+// them earlier, e.g. before the app may be suspended.
+class WriteBehindSqliteCache : public CesiumAsync::ICacheDatabase {
+public:
+    WriteBehindSqliteCache(const std::string& path, const WriteBehindSqliteCacheOptions& options = WriteBehindSqliteCacheOptions())
+        : _path(path), _options(options) {
+        if (!_options.blobDirectory.empty()) {
+            std::filesystem::create_directories(_options.blobDirectory);
+        }
+        _pWriteDb = openDatabase(path);
+        _pReadDb = openDatabase(path);
+        execute(_pWriteDb,
+            "CREATE TABLE IF NOT EXISTS CacheEntries ("
+            "key TEXT PRIMARY KEY NOT NULL, "
+            "expiryTime INTEGER NOT NULL, "
+            "lastAccessedTime INTEGER NOT NULL, "
+            "url TEXT NOT NULL, "
+            "method TEXT NOT NULL, "
+            "requestHeaders BLOB NOT NULL, "
+            "statusCode INTEGER NOT NULL, "
+            "responseHeaders BLOB NOT NULL, "
+            "data BLOB NOT NULL, "
+            "blobHash TEXT NOT NULL DEFAULT '', "
+            "size INTEGER NOT NULL DEFAULT 0, "
+            "pinned INTEGER NOT NULL DEFAULT 0)");
+        // databases created by earlier versions lack the later columns
+        addColumnIfMissing("blobHash", "TEXT NOT NULL DEFAULT ''", nullptr);
+        addColumnIfMissing("size", "INTEGER NOT NULL DEFAULT 0", "UPDATE CacheEntries SET size = length(data)");
+        addColumnIfMissing("pinned", "INTEGER NOT NULL DEFAULT 0", nullptr);
+        execute(_pWriteDb, "CREATE INDEX IF NOT EXISTS CacheEntriesExpiry ON CacheEntries (expiryTime)");
+        execute(_pWriteDb, "CREATE INDEX IF NOT EXISTS CacheEntriesLastAccessed ON CacheEntries (lastAccessedTime)");
+        execute(_pWriteDb, "CREATE INDEX IF NOT EXISTS CacheEntriesBlobHash ON CacheEntries (blobHash)");
+        migrateSqliteCacheTable();
+        _writerThread = std::thread([this]() { runWriter(); });
+    }
+
+    ~WriteBehindSqliteCache() {
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _running = false;
+        }
+        _queueCondition.notify_all();
+        _writerThread.join();
+        // the writer has committed everything that was queued
+        sqlite3_close_v2(_pReadDb);
+        sqlite3_close_v2(_pWriteDb);
+    }
+
+    WriteBehindSqliteCache(const WriteBehindSqliteCache&) = delete;
+    WriteBehindSqliteCache& operator=(const WriteBehindSqliteCache&) = delete;
+
+    // The size of the stored response body, without reading the body itself. Not counted as a
+    // cache lookup.
+    std::optional<uint64_t> getEntrySize(const std::string& key) const {
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            for (const auto* pEntries : { &_pending, &_committing }) {
+                auto it = pEntries->find(key);
+                if (it != pEntries->end()) {
+                    return it->second->data.size();
+                }
+            }
+        }
+        std::optional<uint64_t> result;
+        std::lock_guard<std::mutex> lock(_readMutex);
+        sqlite3_stmt* pStatement = prepare(_pReadDb, "SELECT size FROM CacheEntries WHERE key = ?");
+        sqlite3_bind_text(pStatement, 1, key.data(), static_cast<int>(key.size()), SQLITE_TRANSIENT);
+        if (sqlite3_step(pStatement) == SQLITE_ROW) {
+            result = static_cast<uint64_t>(sqlite3_column_int64(pStatement, 0));
+        }
+        sqlite3_finalize(pStatement);
+        return result;
+    }
+
+    // Marks the entry stored under key as used now, for a tier in front of this cache that served it
+    // without calling getEntry(). Applied with the next batch, like the update getEntry() makes.
+    void touch(const std::string& key) {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _touched.push_back(key);
+    }
+
+    // Pins the entry stored under key, e.g. a tile of a seeded region: prune() neither expires nor
+    // evicts it, and getPinnedEntry() still returns it after it expired. A replacing store keeps the
+    // pin. Applied with the next batch, after the stores queued before it.
+    void pin(const std::string& key) {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _pinned.push_back(key);
+    }
+
+    // The entry stored under key if it is pinned, whether or not it has expired.
+    std::optional<CesiumAsync::CacheItem> getPinnedEntry(const std::string& key) const {
+        bool pinned = false;
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            pinned = std::find(_pinned.begin(), _pinned.end(), key) != _pinned.end();
+        }
+        if (!pinned) {
+            std::lock_guard<std::mutex> lock(_readMutex);
+            sqlite3_stmt* pStatement = prepare(_pReadDb, "SELECT 1 FROM CacheEntries WHERE key = ? AND pinned != 0");
+            sqlite3_bind_text(pStatement, 1, key.data(), static_cast<int>(key.size()), SQLITE_TRANSIENT);
+            pinned = sqlite3_step(pStatement) == SQLITE_ROW;
+            sqlite3_finalize(pStatement);
+        }
+        return pinned ? findEntry(key) : std::nullopt;
+    }
+
+    std::optional<CesiumAsync::CacheItem> getEntry(const std::string& key) const override {
+        auto start = std::chrono::steady_clock::now();
+        std::optional<CesiumAsync::CacheItem> result = findEntry(key);
+        _stats.lookupTime.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+        if (result) {
+            _stats.hits++;
+        } else {
+            _stats.misses++;
+        }
+        return result;
+    }
+
+    bool storeEntry(
+        const std::string& key,
+        std::time_t expiryTime,
+        const std::string& url,
+        const std::string& requestMethod,
+        const CesiumAsync::HttpHeaders& requestHeaders,
+        uint16_t statusCode,
+        const CesiumAsync::HttpHeaders& responseHeaders,
+        const gsl::span<const std::byte>& responseData) override {
+
+        auto pEntry = std::make_shared<PendingEntry>();
+        pEntry->expiryTime = expiryTime;
+        pEntry->url = url;
+        pEntry->method = requestMethod;
+        pEntry->requestHeaders = requestHeaders;
+        pEntry->statusCode = statusCode;
+        pEntry->responseHeaders = responseHeaders;
+        pEntry->data.assign(responseData.begin(), responseData.end());
+
+        bool flushNow = false;
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            auto& pPending = _pending[key];
+            if (pPending) {
+                _pendingBytes -= pPending->data.size();
+            }
+            _pendingBytes += pEntry->data.size();
+            pPending = std::move(pEntry);
+            flushNow = _pendingBytes >= _options.flushBytes;
+        }
+        if (flushNow) {
+            _queueCondition.notify_all();
+        }
+        return true;
+    }
+
+    bool prune() override {
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _pruneRequested = true;
+        }
+        _queueCondition.notify_all();
+        return true;
+    }
+
+    bool clearAll() override {
+        std::lock_guard<std::mutex> writeLock(_writeMutex);
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _pending.clear();
+            _touched.clear();
+            _pinned.clear();
+            _pendingBytes = 0;
+        }
+        bool ok = execute(_pWriteDb, "DELETE FROM CacheEntries");
+        if (ok && !_options.blobDirectory.empty()) {
+            std::error_code error;
+            for (const auto& file : std::filesystem::directory_iterator(_options.blobDirectory, error)) {
+                std::filesystem::remove(file.path(), error);
+            }
+        }
+        return ok;
+    }
+
+    // Commits all queued entries before returning.
+    void flush() {
+        std::lock_guard<std::mutex> writeLock(_writeMutex);
+        commitPending();
+    }
+
+    SqliteCacheStats& getStats() {
+        return _stats;
+    }
+
+    // Counts the stored entries; this scans the table, so it is meant for occasional telemetry.
+    SqliteCacheUsage getUsage() const {
+        SqliteCacheUsage usage;
+        {
+            std::lock_guard<std::mutex> lock(_readMutex);
+            sqlite3_stmt* pStatement = prepare(_pReadDb, "SELECT COUNT(*), COALESCE(SUM(size), 0) FROM CacheEntries");
+            if (sqlite3_step(pStatement) == SQLITE_ROW) {
+                usage.entries = static_cast<uint64_t>(sqlite3_column_int64(pStatement, 0));
+                usage.bytes = static_cast<uint64_t>(sqlite3_column_int64(pStatement, 1));
+            }
+            sqlite3_finalize(pStatement);
+        }
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        usage.pendingEntries = _pending.size() + _committing.size();
+        return usage;
+    }
+
+    // Changes the budget and prunes down to it in the background.
+    void setLimits(uint64_t maxItems, uint64_t maxBytes) {
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _options.maxItems = maxItems;
+            _options.maxBytes = maxBytes;
+        }
+        prune();
+    }
+
+    // Takes effect with the next prune.
+    void setPolicy(CachePrunePolicy policy) {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _options.policy = policy;
+    }
+
+private:
+    struct PendingEntry {
+        std::time_t expiryTime;
+        std::string url;
+        std::string method;
+        CesiumAsync::HttpHeaders requestHeaders;
+        uint16_t statusCode;
+        CesiumAsync::HttpHeaders responseHeaders;
+        std::vector<std::byte> data;
+    };
+    using PendingEntries = std::unordered_map<std::string, std::shared_ptr<const PendingEntry>>;
+
+    std::string _path;
+    WriteBehindSqliteCacheOptions _options;
+    sqlite3* _pWriteDb = nullptr;
+    sqlite3* _pReadDb = nullptr;
+    mutable std::mutex _readMutex;
+    // Held while the write connection is in use, so flush() and clearAll() can run on any thread.
+    std::mutex _writeMutex;
+
+    mutable std::mutex _queueMutex;
+    std::condition_variable _queueCondition;
+    PendingEntries _pending;
+    // Entries taken from _pending by the transaction in progress; still visible to getEntry().
+    PendingEntries _committing;
+    mutable std::vector<std::string> _touched;
+    std::vector<std::string> _pinned;
+    size_t _pendingBytes = 0;
+    bool _pruneRequested = false;
+    bool _running = true;
+    std::thread _writerThread;
+    mutable SqliteCacheStats _stats;
+
+    std::optional<CesiumAsync::CacheItem> findEntry(const std::string& key) const {
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            for (const auto* pEntries : { &_pending, &_committing }) {
+                auto it = pEntries->find(key);
+                if (it != pEntries->end()) {
+                    return toCacheItem(*it->second);
+                }
+            }
+        }
+
+        std::optional<CesiumAsync::CacheItem> result;
+        {
+            std::lock_guard<std::mutex> lock(_readMutex);
+            sqlite3_stmt* pStatement = prepare(_pReadDb,
+                "SELECT expiryTime, url, method, requestHeaders, statusCode, responseHeaders, data, blobHash FROM CacheEntries WHERE key = ?");
+            sqlite3_bind_text(pStatement, 1, key.data(), static_cast<int>(key.size()), SQLITE_TRANSIENT);
+            if (sqlite3_step(pStatement) == SQLITE_ROW) {
+                auto data = static_cast<const std::byte*>(sqlite3_column_blob(pStatement, 6));
+                size_t size = static_cast<size_t>(sqlite3_column_bytes(pStatement, 6));
+                std::string blobHash = columnString(pStatement, 7);
+                std::shared_ptr<MappedFile> pBlob;
+                if (!blobHash.empty()) {
+                    // a mapping stays valid even if prune() unlinks the file meanwhile
+                    pBlob = MappedFile::open(getBlobPath(blobHash));
+                    if (!pBlob) {
+                        sqlite3_finalize(pStatement);
+                        return std::nullopt;
+                    }
+                    data = pBlob->data().data();
+                    size = pBlob->data().size();
+                }
+                result.emplace(
+                    static_cast<std::time_t>(sqlite3_column_int64(pStatement, 0)),
+                    CesiumAsync::CacheRequest(
+                        parseHeaders(columnString(pStatement, 3)),
+                        columnString(pStatement, 2),
+                        columnString(pStatement, 1)),
+                    CesiumAsync::CacheResponse(
+                        static_cast<uint16_t>(sqlite3_column_int(pStatement, 4)),
+                        parseHeaders(columnString(pStatement, 5)),
+                        std::vector<std::byte>(data, data + size)));
+            }
+            sqlite3_finalize(pStatement);
+        }
+
+        if (result) {
+            // the access time only drives pruning, so it is updated with the next batch
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            _touched.push_back(key);
+        }
+        return result;
+    }
+
+    void runWriter() {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        while (_running) {
+            _queueCondition.wait_for(lock, _options.flushInterval, [this]() {
+                return !_running || _pruneRequested || _pendingBytes >= _options.flushBytes;
+            });
+            bool prune = _pruneRequested;
+            _pruneRequested = false;
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> writeLock(_writeMutex);
+                commitPending();
+                if (prune) {
+                    pruneEntries();
+                }
+            }
+            lock.lock();
+        }
+        lock.unlock();
+        std::lock_guard<std::mutex> writeLock(_writeMutex);
+        commitPending();
+    }
+
+    // Must be called with _writeMutex held.
+    void commitPending() {
+        std::vector<std::string> touched;
+        std::vector<std::string> pinned;
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            if (_pending.empty() && _touched.empty() && _pinned.empty()) {
+                return;
+            }
+            _committing.swap(_pending);
+            touched.swap(_touched);
+            pinned.swap(_pinned);
+            _pendingBytes = 0;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::time_t now = std::time(nullptr);
+        bool blobs = !_options.blobDirectory.empty();
+        // blobs of replaced entries, removed after the commit if nothing else refers to them
+        std::unordered_set<std::string> replacedBlobs;
+        bool ok = execute(_pWriteDb, "BEGIN IMMEDIATE");
+        if (ok) {
+            sqlite3_stmt* pInsert = prepare(_pWriteDb,
+                "INSERT OR REPLACE INTO CacheEntries "
+                "(key, expiryTime, lastAccessedTime, url, method, requestHeaders, statusCode, responseHeaders, data, blobHash, size, pinned) "
+                "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, "
+                "COALESCE((SELECT pinned FROM CacheEntries WHERE key = ?1), 0))");
+            sqlite3_stmt* pSelectBlob = blobs ? prepare(_pWriteDb, "SELECT blobHash FROM CacheEntries WHERE key = ?") : nullptr;
+            for (const auto& [key, pEntry] : _committing) {
+                std::string blobHash;
+                if (blobs) {
+                    sqlite3_bind_text(pSelectBlob, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+                    if (sqlite3_step(pSelectBlob) == SQLITE_ROW) {
+                        replacedBlobs.insert(columnString(pSelectBlob, 0));
+                    }
+                    sqlite3_reset(pSelectBlob);
+                    blobHash = writeBlob(pEntry->data);
+                    if (blobHash.empty()) {
+                        continue;
+                    }
+                }
+                std::string requestHeaders = serializeHeaders(pEntry->requestHeaders);
+                std::string responseHeaders = serializeHeaders(pEntry->responseHeaders);
+                sqlite3_bind_text(pInsert, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+                sqlite3_bind_int64(pInsert, 2, static_cast<sqlite3_int64>(pEntry->expiryTime));
+                sqlite3_bind_int64(pInsert, 3, static_cast<sqlite3_int64>(now));
+                sqlite3_bind_text(pInsert, 4, pEntry->url.data(), static_cast<int>(pEntry->url.size()), SQLITE_STATIC);
+                sqlite3_bind_text(pInsert, 5, pEntry->method.data(), static_cast<int>(pEntry->method.size()), SQLITE_STATIC);
+                sqlite3_bind_blob(pInsert, 6, requestHeaders.data(), static_cast<int>(requestHeaders.size()), SQLITE_STATIC);
+                sqlite3_bind_int(pInsert, 7, pEntry->statusCode);
+                sqlite3_bind_blob(pInsert, 8, responseHeaders.data(), static_cast<int>(responseHeaders.size()), SQLITE_STATIC);
+                if (blobs) {
+                    sqlite3_bind_zeroblob(pInsert, 9, 0);
+                } else {
+                    sqlite3_bind_blob64(pInsert, 9, pEntry->data.data(), pEntry->data.size(), SQLITE_STATIC);
+                }
+                sqlite3_bind_text(pInsert, 10, blobHash.data(), static_cast<int>(blobHash.size()), SQLITE_STATIC);
+                sqlite3_bind_int64(pInsert, 11, static_cast<sqlite3_int64>(pEntry->data.size()));
+                if (sqlite3_step(pInsert) != SQLITE_DONE) {
+                    spdlog::default_logger()->warn("Failed to store cache entry {}: {}", key, sqlite3_errmsg(_pWriteDb));
+                }
+                sqlite3_reset(pInsert);
+                sqlite3_clear_bindings(pInsert);
+            }
+            sqlite3_finalize(pInsert);
+            sqlite3_finalize(pSelectBlob);
+
+            sqlite3_stmt* pTouch = prepare(_pWriteDb, "UPDATE CacheEntries SET lastAccessedTime = ? WHERE key = ?");
+            for (const std::string& key : touched) {
+                sqlite3_bind_int64(pTouch, 1, static_cast<sqlite3_int64>(now));
+                sqlite3_bind_text(pTouch, 2, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+                sqlite3_step(pTouch);
+                sqlite3_reset(pTouch);
+            }
+            sqlite3_finalize(pTouch);
+
+            sqlite3_stmt* pPin = prepare(_pWriteDb, "UPDATE CacheEntries SET pinned = 1 WHERE key = ?");
+            for (const std::string& key : pinned) {
+                sqlite3_bind_text(pPin, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+                sqlite3_step(pPin);
+                sqlite3_reset(pPin);
+            }
+            sqlite3_finalize(pPin);
+            ok = execute(_pWriteDb, "COMMIT");
+        }
+        if (!ok && !sqlite3_get_autocommit(_pWriteDb)) {
+            execute(_pWriteDb, "ROLLBACK");
+        }
+        if (ok) {
+            removeUnreferencedBlobs(replacedBlobs);
+        }
+
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        _stats.commitTime.record(static_cast<uint64_t>(duration.count()));
+        spdlog::default_logger()->debug("Committed {} cache entries in {} us", _committing.size(), duration.count());
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        _committing.clear();
+    }
+
+    // Removes expired entries, then the ones the policy ranks lowest until the cache is within
+    // maxItems and maxBytes. Pinned entries are left alone and not counted against the budget.
+    // Must be called with _writeMutex held.
+    void pruneEntries() {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t maxItems;
+        uint64_t maxBytes;
+        CachePrunePolicy policy;
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            maxItems = _options.maxItems;
+            maxBytes = _options.maxBytes;
+            policy = _options.policy;
+        }
+        // entries are kept in this order while within budget
+        std::string order = policy == CachePrunePolicy::ExpiryFirst
+            ? "expiryTime DESC, lastAccessedTime DESC"
+            : "lastAccessedTime DESC";
+
+        std::unordered_set<std::string> removedBlobs;
+        uint64_t removed = 0;
+        auto deleteEntries = [&](sqlite3_stmt* pStatement) {
+            while (sqlite3_step(pStatement) == SQLITE_ROW) {
+                removedBlobs.insert(columnString(pStatement, 0));
+                removed++;
+            }
+            sqlite3_finalize(pStatement);
+        };
+
+        sqlite3_stmt* pExpired = prepare(_pWriteDb, "DELETE FROM CacheEntries WHERE expiryTime < ? AND pinned = 0 RETURNING blobHash");
+        sqlite3_bind_int64(pExpired, 1, static_cast<sqlite3_int64>(std::time(nullptr)));
+        deleteEntries(pExpired);
+
+        if (maxItems > 0) {
+            std::string sql = "DELETE FROM CacheEntries WHERE key IN "
+                "(SELECT key FROM CacheEntries WHERE pinned = 0 ORDER BY " + order + " LIMIT -1 OFFSET ?) RETURNING blobHash";
+            sqlite3_stmt* pOverCount = prepare(_pWriteDb, sql.c_str());
+            sqlite3_bind_int64(pOverCount, 1, static_cast<sqlite3_int64>(maxItems));
+            deleteEntries(pOverCount);
+        }
+        if (maxBytes > 0) {
+            std::string sql = "DELETE FROM CacheEntries WHERE key IN "
+                "(SELECT key FROM (SELECT key, SUM(size) OVER (ORDER BY " + order + " ROWS UNBOUNDED PRECEDING) AS total "
+                "FROM CacheEntries WHERE pinned = 0) WHERE total > ?) RETURNING blobHash";
+            sqlite3_stmt* pOverSize = prepare(_pWriteDb, sql.c_str());
+            sqlite3_bind_int64(pOverSize, 1, static_cast<sqlite3_int64>(maxBytes));
+            deleteEntries(pOverSize);
+        }
+
+        removeUnreferencedBlobs(removedBlobs);
+        _stats.prunes++;
+        _stats.prunedEntries += removed;
+        _stats.pruneTime.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+    }
+
+    // Moves the entries of CesiumAsync::SqliteCache, which earlier versions used on the same file, into
+    // CacheEntries and drops its table, so the old entries are neither lost nor kept outside the
+    // budget forever. If the old table does not have the expected columns it is only dropped.
+    void migrateSqliteCacheTable() {
+        std::vector<std::string> columns;
+        sqlite3_stmt* pColumns = prepare(_pWriteDb, "SELECT name FROM pragma_table_info('CacheItemTable')");
+        while (pColumns && sqlite3_step(pColumns) == SQLITE_ROW) {
+            columns.push_back(columnString(pColumns, 0));
+        }
+        sqlite3_finalize(pColumns);
+        if (columns.empty()) {
+            return;
+        }
+
+        auto findColumn = [&](const char* part) -> std::string {
+            for (const std::string& column : columns) {
+                if (column.find(part) != std::string::npos) {
+                    return column;
+                }
+            }
+            return "";
+        };
+        const char* parts[] = { "key", "expiryTime", "lastAccessedTime", "requestUrl", "requestMethod",
+            "requestHeader", "responseStatusCode", "responseHeader", "responseData" };
+        std::string select = "SELECT ";
+        bool complete = true;
+        for (const char* part : parts) {
+            std::string column = findColumn(part);
+            complete = complete && !column.empty();
+            select += (select.size() > 7 ? ", " : "") + column;
+        }
+        select += " FROM CacheItemTable";
+
+        uint64_t migrated = 0;
+        bool blobs = !_options.blobDirectory.empty();
+        bool ok = execute(_pWriteDb, "BEGIN IMMEDIATE");
+        if (ok && complete) {
+            sqlite3_stmt* pSelect = prepare(_pWriteDb, select.c_str());
+            sqlite3_stmt* pInsert = prepare(_pWriteDb,
+                "INSERT OR IGNORE INTO CacheEntries "
+                "(key, expiryTime, lastAccessedTime, url, method, requestHeaders, statusCode, responseHeaders, data, blobHash, size) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            while (pSelect && pInsert && sqlite3_step(pSelect) == SQLITE_ROW) {
+                const std::byte* pData = static_cast<const std::byte*>(sqlite3_column_blob(pSelect, 8));
+                std::vector<std::byte> data(pData, pData + sqlite3_column_bytes(pSelect, 8));
+                std::string blobHash;
+                if (blobs) {
+                    blobHash = writeBlob(data);
+                    if (blobHash.empty()) {
+                        continue;
+                    }
+                }
+                std::string key = columnString(pSelect, 0);
+                std::string url = columnString(pSelect, 3);
+                std::string method = columnString(pSelect, 4);
+                std::string requestHeaders = serializeHeaders(parseJsonHeaders(columnString(pSelect, 5)));
+                std::string responseHeaders = serializeHeaders(parseJsonHeaders(columnString(pSelect, 7)));
+                sqlite3_bind_text(pInsert, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+                sqlite3_bind_int64(pInsert, 2, sqlite3_column_int64(pSelect, 1));
+                sqlite3_bind_int64(pInsert, 3, sqlite3_column_int64(pSelect, 2));
+                sqlite3_bind_text(pInsert, 4, url.data(), static_cast<int>(url.size()), SQLITE_STATIC);
+                sqlite3_bind_text(pInsert, 5, method.data(), static_cast<int>(method.size()), SQLITE_STATIC);
+                sqlite3_bind_blob(pInsert, 6, requestHeaders.data(), static_cast<int>(requestHeaders.size()), SQLITE_STATIC);
+                sqlite3_bind_int(pInsert, 7, sqlite3_column_int(pSelect, 6));
+                sqlite3_bind_blob(pInsert, 8, responseHeaders.data(), static_cast<int>(responseHeaders.size()), SQLITE_STATIC);
+                if (blobs) {
+                    sqlite3_bind_zeroblob(pInsert, 9, 0);
+                } else {
+                    sqlite3_bind_blob64(pInsert, 9, data.data(), data.size(), SQLITE_STATIC);
+                }
+                sqlite3_bind_text(pInsert, 10, blobHash.data(), static_cast<int>(blobHash.size()), SQLITE_STATIC);
+                sqlite3_bind_int64(pInsert, 11, static_cast<sqlite3_int64>(data.size()));
+                if (sqlite3_step(pInsert) == SQLITE_DONE) {
+                    migrated++;
+                }
+                sqlite3_reset(pInsert);
+                sqlite3_clear_bindings(pInsert);
+            }
+            sqlite3_finalize(pInsert);
+            sqlite3_finalize(pSelect);
+        }
+        ok = ok && execute(_pWriteDb, "DROP TABLE IF EXISTS CacheItemTable") && execute(_pWriteDb, "COMMIT");
+        if (!ok) {
+            if (!sqlite3_get_autocommit(_pWriteDb)) {
+                execute(_pWriteDb, "ROLLBACK");
+            }
+            return;
+        }
+        // give the space of the old table back to the file system
+        execute(_pWriteDb, "VACUUM");
+        spdlog::default_logger()->info("Migrated {} entries of the previous cache table", migrated);
+    }
+
+    // The JSON object of header names and values that CesiumAsync::SqliteCache stored.
+    static CesiumAsync::HttpHeaders parseJsonHeaders(const std::string& json) {
+        CesiumAsync::HttpHeaders headers;
+        rapidjson::Document document;
+        document.Parse(json.data(), json.size());
+        if (document.HasParseError() || !document.IsObject()) {
+            return headers;
+        }
+        for (const auto& member : document.GetObject()) {
+            if (member.value.IsString()) {
+                headers[member.name.GetString()] = member.value.GetString();
+            }
+        }
+        return headers;
+    }
+
+    // Adds a column introduced after the table was first created; migrate fills it for existing rows.
+    void addColumnIfMissing(const char* name, const char* definition, const char* migrate) {
+        sqlite3_stmt* pStatement = prepare(_pWriteDb, "SELECT 1 FROM pragma_table_info('CacheEntries') WHERE name = ?");
+        sqlite3_bind_text(pStatement, 1, name, -1, SQLITE_STATIC);
+        bool exists = sqlite3_step(pStatement) == SQLITE_ROW;
+        sqlite3_finalize(pStatement);
+        if (exists) {
+            return;
+        }
+        std::string sql = std::string("ALTER TABLE CacheEntries ADD COLUMN ") + name + " " + definition;
+        if (execute(_pWriteDb, sql.c_str()) && migrate) {
+            execute(_pWriteDb, migrate);
+        }
+    }
+
+    std::string getBlobPath(const std::string& hash) const {
+        return _options.blobDirectory + "/" + hash;
+    }
+
+    // Writes data to its content-addressed file unless that already exists. Returns the hash, or an
+    // empty string if the file could not be written. Must be called with _writeMutex held.
+    std::string writeBlob(const std::vector<std::byte>& data) {
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        if (!EVP_Digest(data.data(), data.size(), digest, &length, EVP_sha256(), nullptr)) {
+            spdlog::default_logger()->error("Failed to hash cache entry");
+            return "";
+        }
+        static const char* kHexDigits = "0123456789abcdef";
+        std::string hash;
+        for (unsigned int i = 0; i < length; i++) {
+            hash.push_back(kHexDigits[digest[i] >> 4]);
+            hash.push_back(kHexDigits[digest[i] & 0xf]);
+        }
+
+        std::string path = getBlobPath(hash);
+        std::error_code error;
+        if (std::filesystem::exists(path, error)) {
+            return hash;
+        }
+        // written under a temporary name so a reader never maps a partial file
+        std::string temporaryPath = path + ".tmp";
+        {
+            std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!stream) {
+                spdlog::default_logger()->error("Failed to write cache file {}", temporaryPath);
+                std::filesystem::remove(temporaryPath, error);
+                return "";
+            }
+        }
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) {
+            spdlog::default_logger()->error("Failed to write cache file {}: {}", path, error.message());
+            std::filesystem::remove(temporaryPath, error);
+            return "";
+        }
+        return hash;
+    }
+
+    // Unlinks the given blobs unless an entry still refers to them. Must be called with _writeMutex held.
+    void removeUnreferencedBlobs(const std::unordered_set<std::string>& blobHashes) {
+        if (blobHashes.empty() || _options.blobDirectory.empty()) {
+            return;
+        }
+        sqlite3_stmt* pReferenced = prepare(_pWriteDb, "SELECT 1 FROM CacheEntries WHERE blobHash = ? LIMIT 1");
+        for (const std::string& hash : blobHashes) {
+            if (hash.empty()) {
+                continue;
+            }
+            sqlite3_bind_text(pReferenced, 1, hash.data(), static_cast<int>(hash.size()), SQLITE_STATIC);
+            bool referenced = sqlite3_step(pReferenced) == SQLITE_ROW;
+            sqlite3_reset(pReferenced);
+            if (!referenced) {
+                std::error_code error;
+                std::filesystem::remove(getBlobPath(hash), error);
+            }
+        }
+        sqlite3_finalize(pReferenced);
+    }
+
+    static sqlite3* openDatabase(const std::string& path) {
+        sqlite3* pDb = nullptr;
+        if (sqlite3_open_v2(path.c_str(), &pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, nullptr) != SQLITE_OK) {
+            std::string message = pDb ? sqlite3_errmsg(pDb) : "out of memory";
+            sqlite3_close_v2(pDb);
+            throw std::runtime_error("Failed to open cache database " + path + ": " + message);
+        }
+        // a cache can lose its last commits on power loss, so there is no need to sync every one
+        execute(pDb, "PRAGMA journal_mode=WAL");
+        execute(pDb, "PRAGMA synchronous=NORMAL");
+        sqlite3_busy_timeout(pDb, 5000);
+        return pDb;
+    }
+
+    static bool execute(sqlite3* pDb, const char* sql) {
+        char* pError = nullptr;
+        if (sqlite3_exec(pDb, sql, nullptr, nullptr, &pError) != SQLITE_OK) {
+            spdlog::default_logger()->error("Cache database error in \"{}\": {}", sql, pError ? pError : "unknown");
+            sqlite3_free(pError);
+            return false;
+        }
+        return true;
+    }
+
+    static sqlite3_stmt* prepare(sqlite3* pDb, const char* sql) {
+        sqlite3_stmt* pStatement = nullptr;
+        if (sqlite3_prepare_v2(pDb, sql, -1, &pStatement, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::string("Failed to prepare cache statement: ") + sqlite3_errmsg(pDb));
+        }
+        return pStatement;
+    }
+
+    static std::string columnString(sqlite3_stmt* pStatement, int column) {
+        auto text = static_cast<const char*>(sqlite3_column_blob(pStatement, column));
+        return std::string(text ? text : "", static_cast<size_t>(sqlite3_column_bytes(pStatement, column)));
+    }
+
+    // Headers are stored as "name\0value\0" pairs.
+    static std::string serializeHeaders(const CesiumAsync::HttpHeaders& headers) {
+        std::string result;
+        for (const auto& [name, value] : headers) {
+            result.append(name).push_back('\0');
+            result.append(value).push_back('\0');
+        }
+        return result;
+    }
+
+    static CesiumAsync::HttpHeaders parseHeaders(const std::string& serialized) {
+        CesiumAsync::HttpHeaders headers;
+        size_t position = 0;
+        while (position < serialized.size()) {
+            size_t nameEnd = serialized.find('\0', position);
+            size_t valueEnd = nameEnd == std::string::npos ? std::string::npos : serialized.find('\0', nameEnd + 1);
+            if (valueEnd == std::string::npos) {
+                break;
+            }
+            headers[serialized.substr(position, nameEnd - position)] = serialized.substr(nameEnd + 1, valueEnd - nameEnd - 1);
+            position = valueEnd + 1;
+        }
+        return headers;
+    }
+
+    static CesiumAsync::CacheItem toCacheItem(const PendingEntry& entry) {
+        return CesiumAsync::CacheItem(
+            entry.expiryTime,
+            CesiumAsync::CacheRequest(CesiumAsync::HttpHeaders(entry.requestHeaders), std::string(entry.method), std::string(entry.url)),
+            CesiumAsync::CacheResponse(entry.statusCode, CesiumAsync::HttpHeaders(entry.responseHeaders), std::vector<std::byte>(entry.data)));
+    }
+};
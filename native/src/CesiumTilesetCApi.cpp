@@ -6,10 +6,12 @@
 #include "spdlog/sinks/android_sink.h"
 #endif
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -21,6 +23,7 @@
 #include <openssl/buffer.h>
 #include <string>
 #include <cstring>
+#include <filesystem>
 
 #include <glm/ext/matrix_transform.hpp>
 #include <spdlog/spdlog.h>
@@ -33,7 +36,6 @@
 #include <CesiumAsync/IAssetAccessor.h>
 #include <CesiumAsync/AsyncSystem.h>
 #include <CesiumAsync/CachingAssetAccessor.h>
-#include <CesiumAsync/SqliteCache.h>
 #include <Cesium3DTilesContent/registerAllTileContentTypes.h>
 #include <Cesium3DTilesSelection/BoundingVolume.h>
 #include <CesiumGeometry/BoundingSphere.h>
@@ -43,11 +45,26 @@
 #include <CesiumGltfWriter/GltfWriter.h>
 #include <CesiumGltfContent/GltfUtilities.h>
 
-// #ifdef _WIN32
-// #include "HttpLibAssetAccessor.hpp"
-// #else
+#include "HttpLibAssetAccessor.hpp"
 #include "CurlAssetAccessor.hpp"
-// #endif
+#include "CoalescingAssetAccessor.hpp"
+#include "ThrottlingAssetAccessor.hpp"
+#include "ContentDecodingAssetAccessor.hpp"
+#include "WriteBehindSqliteCache.hpp"
+#include "MemoryCacheDatabase.hpp"
+#include "DecodedModelCache.hpp"
+#include "RetryingAssetAccessor.hpp"
+#include "FileAssetAccessor.hpp"
+#include "ArchiveAssetAccessor.hpp"
+#include "RecordReplayAssetAccessor.hpp"
+#include "RevalidatingAssetAccessor.hpp"
+#include "NegativeCachingAssetAccessor.hpp"
+#include "PinnedFallbackAssetAccessor.hpp"
+#include "RegionSeeder.hpp"
+#include "WorkStealingTaskProcessor.hpp"
+#include "PriorityAssetAccessor.hpp"
+#include "IoPoolAssetAccessor.hpp"
+#include "TilesetRequestTracker.hpp"
 
 #include "PrepareRenderer.hpp"
 #include "Base64Encode.hpp"
@@ -56,61 +73,6 @@ namespace DartCesiumNative {
 
     using namespace Cesium3DTilesSelection;
 
-class SimpleTaskProcessor : public CesiumAsync::ITaskProcessor {
-public:
-    SimpleTaskProcessor(size_t numThreads) : running(true) {
-        for (size_t i = 0; i < numThreads; ++i) {
-            workerThreads.emplace_back(&SimpleTaskProcessor::processJobs, this);
-        }
-    }
-
-    ~SimpleTaskProcessor() {
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            running = false;
-            condition.notify_all();
-        }
-        for (auto& thread : workerThreads) {
-            if (thread.joinable()) {
-                thread.join();
-            }
-        }
-    }
-
-    virtual void startTask(std::function<void()> f) override {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        jobQueue.push(std::move(f));
-        condition.notify_one();
-    }
-
-private:
-    void processJobs() {
-        while (running) {
-            std::function<void()> job;
-            {
-                std::unique_lock<std::mutex> lock(queueMutex);
-                condition.wait(lock, [this] { return !jobQueue.empty() || !running; });
-                if (!running && jobQueue.empty()) {
-                    return;
-                }
-                if (!jobQueue.empty()) {
-                    job = std::move(jobQueue.front());
-                    jobQueue.pop();
-                }
-            }
-            if (job) {
-                job();
-            }
-        }
-    }
-
-    std::queue<std::function<void()>> jobQueue;
-    std::mutex queueMutex;
-    std::condition_variable condition;
-    std::vector<std::thread> workerThreads;
-    std::atomic<bool> running;
-};
-
 extern "C" {
 
 struct CesiumTileset {
@@ -118,6 +80,13 @@ struct CesiumTileset {
     Cesium3DTilesSelection::ViewUpdateResult lastUpdateResult;
     bool loadError = false;
     std::string loadErrorMessage;
+    bool cancelStaleTileLoads = false;
+    // Frame at which each loading tile was first seen outside the selection.
+    std::unordered_map<const Tile*, int> staleLoadingTiles;
+    // Per-tileset retry/hedge layer in front of the shared accessor chain.
+    std::shared_ptr<RetryingAssetAccessor> pAssetAccessor;
+    // The requests this tileset has in flight, so only its own downloads are cancelled.
+    std::shared_ptr<TilesetRequestTracker> pRequestTracker;
 };
 
 // Helper function to convert Cesium's glm::dvec3 to our double3
@@ -129,12 +98,72 @@ double3 glmTodouble3(const glm::dvec3& vec) {
 // Specifically, the API does not need re-initializiang after a Dart/Flutter hot reload.
 // This flag is set to true after the first call to CesiumTileset_initialize(); all subsequent calls will be ignored.
 static CesiumAsync::AsyncSystem asyncSystem { nullptr };
+static std::shared_ptr<CesiumAsync::ITaskProcessor> pTaskProcessor;
+// Workers for blocking I/O (cache, local files), so it never occupies the decoding workers above.
+static CesiumAsync::AsyncSystem ioAsyncSystem { nullptr };
+static std::shared_ptr<CesiumAsync::ITaskProcessor> pIoTaskProcessor;
 static std::shared_ptr<Cesium3DTilesSelection::IPrepareRendererResources> pResourcePreparer;
 static std::shared_ptr<CesiumAsync::IAssetAccessor> pAssetAccessor;
+static std::shared_ptr<CurlAssetAccessor> pCurlAssetAccessor;
+static std::shared_ptr<ThrottlingAssetAccessor> pThrottlingAssetAccessor;
+static std::shared_ptr<ContentDecodingAssetAccessor> pContentDecodingAssetAccessor;
+static std::shared_ptr<RevalidatingAssetAccessor> pRevalidatingAssetAccessor;
+static std::shared_ptr<NegativeCachingAssetAccessor> pNegativeCachingAssetAccessor;
+static std::shared_ptr<CoalescingAssetAccessor> pCoalescingAssetAccessor;
+static std::shared_ptr<CesiumAsync::IAssetAccessor> pUncoalescedAssetAccessor;
+static std::shared_ptr<DelayScheduler> pDelayScheduler;
 static std::shared_ptr<CesiumAsync::ICacheDatabase> pCacheDatabase;
+static std::shared_ptr<WriteBehindSqliteCache> pSqliteCache;
+static std::shared_ptr<MemoryCacheDatabase> pMemoryCache;
+static std::shared_ptr<DecodedModelCache> pDecodedModelCache;
 static std::shared_ptr<CesiumUtility::CreditSystem> pMockedCreditSystem;
 static std::thread *main;
-API_EXPORT void CesiumTileset_initialize(uint32_t numThreads, const char* cacheDbPath) {
+
+// Threads finishing the teardown of destroyed seeds (see CesiumTileset_destroySeed). Defined after the
+// accessors and caches above, so it is destroyed, and its threads joined, before any of them.
+class SeedTeardownThreads {
+public:
+    ~SeedTeardownThreads() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (Teardown& teardown : _teardowns) {
+            teardown.thread.join();
+        }
+    }
+
+    void start(std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // reap the teardowns that have finished since the last call
+        _teardowns.erase(std::remove_if(_teardowns.begin(), _teardowns.end(), [](Teardown& teardown) {
+            if (!*teardown.pDone) {
+                return false;
+            }
+            teardown.thread.join();
+            return true;
+        }), _teardowns.end());
+
+        auto pDone = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread([task = std::move(task), pDone]() {
+            task();
+            *pDone = true;
+        });
+        _teardowns.push_back(Teardown { std::move(thread), std::move(pDone) });
+    }
+
+private:
+    struct Teardown {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> pDone;
+    };
+    std::mutex _mutex;
+    std::vector<Teardown> _teardowns;
+};
+static SeedTeardownThreads seedTeardownThreads;
+
+static CachePrunePolicy toCachePrunePolicy(CesiumCachePolicy policy) {
+    return policy == CT_CACHE_EXPIRY_FIRST ? CachePrunePolicy::ExpiryFirst : CachePrunePolicy::LeastRecentlyUsed;
+}
+
+API_EXPORT void CesiumTileset_initialize(uint32_t numThreads, uint32_t numIoThreads, const char* cacheDbPath, CesiumNetworkOptions networkOptions) {
     if(pResourcePreparer) {
         return;
     }
@@ -150,54 +179,368 @@ API_EXPORT void CesiumTileset_initialize(uint32_t numThreads, const char* cacheD
     spdlog::set_level(spdlog::level::info); // Or info, warn, error, etc.
     spdlog::enable_backtrace(32); // Keep a backtrace of 32 messages
     
-    pAssetAccessor = std::make_shared<CurlAssetAccessor>();
-    
-    // Only create caching if a valid path is provided
-    if (cacheDbPath && strlen(cacheDbPath) > 0) {
-        pCacheDatabase = std::make_shared<CesiumAsync::SqliteCache>(
-            spdlog::default_logger(),
-            cacheDbPath,
-            4096
-        );
-        if (pCacheDatabase) {
-            spdlog::default_logger()->info("SQLite cache created successfully at: {}", cacheDbPath);
-            pAssetAccessor = std::make_shared<CesiumAsync::CachingAssetAccessor>(
-                spdlog::default_logger(),
-                pAssetAccessor,
-                pCacheDatabase,
-                10000
-            );
-            spdlog::default_logger()->info("CachingAssetAccessor created with database: {}", cacheDbPath);
-        } else {
-            spdlog::default_logger()->error("Failed to create SQLite cache at: {}", cacheDbPath);
+    pDelayScheduler = std::make_shared<DelayScheduler>();
+
+    CesiumNetworkMode mode = networkOptions.mode;
+    if (mode == CT_NETWORK_REPLAY) {
+        // Everything comes from the recording; no connection, cache or throttling is set up.
+        try {
+            pAssetAccessor = std::make_shared<ReplayAssetAccessor>(
+                networkOptions.recordingPath ? networkOptions.recordingPath : "",
+                networkOptions.simulateRecordedLatency,
+                pDelayScheduler);
+            pUncoalescedAssetAccessor = pAssetAccessor;
+        } catch (const std::exception& e) {
+            spdlog::default_logger()->error("{}; falling back to the network", e.what());
+            mode = CT_NETWORK_LIVE;
         }
+    }
+
+    if (mode == CT_NETWORK_REPLAY) {
+        // answered from the recording alone
+    } else if (networkOptions.httpBackend == CT_HTTP_BACKEND_HTTPLIB) {
+        // httplib negotiates and decodes gzip/deflate itself, so there is no ContentDecodingAssetAccessor.
+        pThrottlingAssetAccessor = std::make_shared<ThrottlingAssetAccessor>(std::make_shared<HttplibAssetAccessor>());
+        pAssetAccessor = pThrottlingAssetAccessor;
     } else {
-        spdlog::default_logger()->info("No cache path provided, running without tile caching");
+        CurlAssetAccessorOptions curlOptions;
+        curlOptions.shareConnectionCache = networkOptions.shareConnectionCache;
+        curlOptions.maxIdleHandles = networkOptions.maxIdleHandles;
+        switch (networkOptions.httpVersion) {
+            case CT_HTTP_1_1:
+                curlOptions.httpVersion = CURL_HTTP_VERSION_1_1;
+                break;
+            case CT_HTTP_2:
+                curlOptions.httpVersion = CURL_HTTP_VERSION_2TLS;
+                break;
+            case CT_HTTP_2_PRIOR_KNOWLEDGE:
+                curlOptions.httpVersion = CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+                break;
+        }
+        curlOptions.maxConcurrentStreams = networkOptions.maxConcurrentStreams;
+        curlOptions.maxConnectionsPerHost = networkOptions.maxConnectionsPerHost;
+        pCurlAssetAccessor = std::make_shared<CurlAssetAccessor>(curlOptions);
+        // Throttling sits below the cache so that cache hits are never delayed.
+        pThrottlingAssetAccessor = std::make_shared<ThrottlingAssetAccessor>(pCurlAssetAccessor);
+        // Each transfer is paced as well, so a large tile does not arrive at line rate.
+        pCurlAssetAccessor->setReceiveRateLimit([pThrottling = std::weak_ptr<ThrottlingAssetAccessor>(pThrottlingAssetAccessor)](const std::string& url) {
+            auto pThrottlingAssetAccessor = pThrottling.lock();
+            return pThrottlingAssetAccessor ? pThrottlingAssetAccessor->getTransferByteRate(url) : 0.0;
+        });
+        // Decoding sits above throttling so that rate limits apply to the bytes on the wire.
+        pContentDecodingAssetAccessor = std::make_shared<ContentDecodingAssetAccessor>(pThrottlingAssetAccessor);
+        pAssetAccessor = pContentDecodingAssetAccessor;
     }
+
+    if (mode != CT_NETWORK_REPLAY) {
+        // Only create caching if a valid path is provided
+        if (cacheDbPath && strlen(cacheDbPath) > 0) {
+            try {
+                // Stores are batched into one transaction every few hundred ms on a writer thread.
+                // A directory selects blob mode: bodies become files and SQLite only holds metadata.
+                std::string cachePath = cacheDbPath;
+                WriteBehindSqliteCacheOptions cacheOptions;
+                cacheOptions.maxItems = networkOptions.cacheMaxItems;
+                cacheOptions.maxBytes = networkOptions.cacheMaxBytes;
+                cacheOptions.policy = toCachePrunePolicy(networkOptions.cachePolicy);
+                std::error_code error;
+                if (cachePath.back() == '/' || cachePath.back() == '\\' || std::filesystem::is_directory(cachePath, error)) {
+                    cacheOptions.blobDirectory = cachePath + "/blobs";
+                    cachePath += "/cache.sqlite";
+                }
+                pSqliteCache = std::make_shared<WriteBehindSqliteCache>(cachePath, cacheOptions);
+                pCacheDatabase = pSqliteCache;
+                if (networkOptions.memoryCacheBytes > 0) {
+                    // recently used responses are served from memory without querying SQLite; hits
+                    // still refresh the access time its pruning evicts by
+                    pMemoryCache = std::make_shared<MemoryCacheDatabase>(
+                        pSqliteCache,
+                        networkOptions.memoryCacheBytes,
+                        [pSqliteCache = pSqliteCache](const std::string& key) { pSqliteCache->touch(key); });
+                    pCacheDatabase = pMemoryCache;
+                }
+            } catch (const std::exception& e) {
+                spdlog::default_logger()->error("{}", e.what());
+            }
+            if (pCacheDatabase) {
+                spdlog::default_logger()->info("SQLite cache created successfully at: {}", cacheDbPath);
+                // CachingAssetAccessor refetches stale entries with If-None-Match/If-Modified-Since and
+                // only refreshes their expiry on a 304; this layer counts those revalidations.
+                pRevalidatingAssetAccessor = std::make_shared<RevalidatingAssetAccessor>(pAssetAccessor, pSqliteCache);
+                pAssetAccessor = std::make_shared<CesiumAsync::CachingAssetAccessor>(
+                    spdlog::default_logger(),
+                    pRevalidatingAssetAccessor,
+                    pCacheDatabase,
+                    networkOptions.cachePruneInterval
+                );
+                // pinned (seeded) entries are still served once expired if refetching them fails
+                pAssetAccessor = std::make_shared<PinnedFallbackAssetAccessor>(pAssetAccessor, pSqliteCache);
+                spdlog::default_logger()->info("CachingAssetAccessor created with database: {}", cacheDbPath);
+            } else {
+                spdlog::default_logger()->error("Failed to create SQLite cache at: {}", cacheDbPath);
+            }
+        } else {
+            spdlog::default_logger()->info("No cache path provided, running without tile caching");
+        }
+
+        if (networkOptions.negativeCacheTtlSeconds > 0) {
+            // Missing content of implicit tilesets is answered locally instead of being requested on every revisit.
+            pNegativeCachingAssetAccessor = std::make_shared<NegativeCachingAssetAccessor>(
+                pAssetAccessor,
+                std::chrono::seconds(networkOptions.negativeCacheTtlSeconds),
+                networkOptions.negativeCacheMaxEntries);
+            pAssetAccessor = pNegativeCachingAssetAccessor;
+        }
+
+        // Identical requests in flight at the same time (e.g. two tilesets sharing an external
+        // tileset.json) share a single download and a single cache write.
+        // Hedged requests skip this layer, otherwise they would just join the request they hedge.
+        pUncoalescedAssetAccessor = pAssetAccessor;
+        pCoalescingAssetAccessor = std::make_shared<CoalescingAssetAccessor>(pAssetAccessor);
+        pAssetAccessor = pCoalescingAssetAccessor;
+
+        if (mode == CT_NETWORK_RECORD) {
+            // Recorded above the cache so that a replay also covers requests answered from it.
+            try {
+                pAssetAccessor = std::make_shared<RecordingAssetAccessor>(
+                    pAssetAccessor,
+                    networkOptions.recordingPath ? networkOptions.recordingPath : "");
+            } catch (const std::exception& e) {
+                spdlog::default_logger()->error("{}; continuing without recording", e.what());
+            }
+        }
+    }
+
+    // On-disk tilesets are memory-mapped rather than fetched, cached or throttled.
+    pAssetAccessor = std::make_shared<FileAssetAccessor>(pAssetAccessor);
+    // Entries of local .3tz archives, e.g. "/data/city.3tz/tileset.json".
+    pAssetAccessor = std::make_shared<ArchiveAssetAccessor>(pAssetAccessor);
     
-    asyncSystem = CesiumAsync::AsyncSystem {  std::make_shared<SimpleTaskProcessor>(numThreads) };
+    if (numThreads == 0) {
+        // one core is left to the UI thread
+        numThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+    pTaskProcessor = std::make_shared<WorkStealingTaskProcessor>(numThreads);
+    asyncSystem = CesiumAsync::AsyncSystem { pTaskProcessor };
+    pIoTaskProcessor = std::make_shared<WorkStealingTaskProcessor>(numIoThreads);
+    ioAsyncSystem = CesiumAsync::AsyncSystem { pIoTaskProcessor };
 
     pMockedCreditSystem = std::make_shared<CesiumUtility::CreditSystem>();
+    if (pCacheDatabase) {
+        pDecodedModelCache = std::make_shared<DecodedModelCache>(pCacheDatabase, TilesetContentOptions());
+    }
     pResourcePreparer = std::dynamic_pointer_cast<Cesium3DTilesSelection::IPrepareRendererResources>(std::make_shared<SimplePrepareRendererResource>());
     
     Cesium3DTilesContent::registerAllTileContentTypes();
     
-    spdlog::default_logger()->info("Cesium Native bindings initialized ({} threads)", numThreads);
+    spdlog::default_logger()->info("Cesium Native bindings initialized ({} CPU threads, {} I/O threads)", numThreads, std::max(numIoThreads, 1u));
+}
+
+CesiumConnectionStats CesiumTileset_getConnectionStats() {
+    CesiumConnectionStats stats {};
+    if (!pCurlAssetAccessor) {
+        return stats;
+    }
+    auto curlStats = pCurlAssetAccessor->getStats();
+    stats.requests = curlStats.requests;
+    stats.newConnections = curlStats.newConnections;
+    stats.reusedConnections = curlStats.reusedConnections;
+    stats.reusedHandles = curlStats.reusedHandles;
+    stats.cancelledRequests = curlStats.cancelledRequests;
+    stats.bytesSavedByCancellation = curlStats.bytesSavedByCancellation;
+    if (pRevalidatingAssetAccessor) {
+        auto revalidationStats = pRevalidatingAssetAccessor->getStats();
+        stats.revalidations = revalidationStats.revalidations;
+        stats.notModifiedResponses = revalidationStats.notModified;
+        stats.bytesSavedByRevalidation = revalidationStats.bytesSaved;
+    }
+    return stats;
+}
+
+static void copyHistogram(Histogram& histogram, bool reset, CesiumNetworkHistogram& out) {
+    static_assert(Histogram::kBuckets == CESIUM_NETWORK_HISTOGRAM_BUCKETS, "histogram bucket counts must match");
+    auto snapshot = histogram.snapshot(reset);
+    out.count = snapshot.count;
+    out.sum = snapshot.sum;
+    out.max = snapshot.max;
+    std::copy(snapshot.buckets.begin(), snapshot.buckets.end(), out.buckets);
+}
+
+CesiumNetworkStats CesiumTileset_getNetworkStats(bool reset) {
+    CesiumNetworkStats stats {};
+    if (!pCurlAssetAccessor) {
+        return stats;
+    }
+    auto& timingStats = pCurlAssetAccessor->getTimingStats();
+    copyHistogram(timingStats.dnsTime, reset, stats.dnsTime);
+    copyHistogram(timingStats.connectTime, reset, stats.connectTime);
+    copyHistogram(timingStats.tlsTime, reset, stats.tlsTime);
+    copyHistogram(timingStats.timeToFirstByte, reset, stats.timeToFirstByte);
+    copyHistogram(timingStats.totalTime, reset, stats.totalTime);
+    copyHistogram(timingStats.responseBytes, reset, stats.responseBytes);
+    stats.http1Requests = reset ? timingStats.http1Requests.exchange(0) : timingStats.http1Requests.load();
+    stats.http2Requests = reset ? timingStats.http2Requests.exchange(0) : timingStats.http2Requests.load();
+    stats.http3Requests = reset ? timingStats.http3Requests.exchange(0) : timingStats.http3Requests.load();
+    if (pContentDecodingAssetAccessor) {
+        auto& decodingStats = pContentDecodingAssetAccessor->getStats();
+        copyHistogram(decodingStats.decodeTime, reset, stats.decodeTime);
+        stats.gzipResponses = reset ? decodingStats.gzipResponses.exchange(0) : decodingStats.gzipResponses.load();
+        stats.brotliResponses = reset ? decodingStats.brotliResponses.exchange(0) : decodingStats.brotliResponses.load();
+        stats.zstdResponses = reset ? decodingStats.zstdResponses.exchange(0) : decodingStats.zstdResponses.load();
+        stats.compressedBytes = reset ? decodingStats.compressedBytes.exchange(0) : decodingStats.compressedBytes.load();
+        stats.decodedBytes = reset ? decodingStats.decodedBytes.exchange(0) : decodingStats.decodedBytes.load();
+    }
+    return stats;
+}
+
+CesiumCacheStats CesiumTileset_getCacheStats(bool reset) {
+    CesiumCacheStats stats {};
+    if (pMemoryCache) {
+        auto memoryStats = pMemoryCache->getStats();
+        stats.memoryHits = memoryStats.hits;
+        stats.memoryMisses = memoryStats.misses;
+        stats.memoryEvictions = memoryStats.evictions;
+        stats.memoryEntries = memoryStats.entries;
+        stats.memoryBytes = memoryStats.bytes;
+    }
+    if (pSqliteCache) {
+        auto& sqliteStats = pSqliteCache->getStats();
+        stats.hits = reset ? sqliteStats.hits.exchange(0) : sqliteStats.hits.load();
+        stats.misses = reset ? sqliteStats.misses.exchange(0) : sqliteStats.misses.load();
+        stats.prunes = reset ? sqliteStats.prunes.exchange(0) : sqliteStats.prunes.load();
+        stats.prunedEntries = reset ? sqliteStats.prunedEntries.exchange(0) : sqliteStats.prunedEntries.load();
+        copyHistogram(sqliteStats.lookupTime, reset, stats.lookupTime);
+        copyHistogram(sqliteStats.pruneTime, reset, stats.pruneTime);
+        copyHistogram(sqliteStats.commitTime, reset, stats.commitTime);
+        auto usage = pSqliteCache->getUsage();
+        stats.entries = usage.entries;
+        stats.bytes = usage.bytes;
+        stats.pendingEntries = usage.pendingEntries;
+    }
+    if (pDecodedModelCache) {
+        auto decodedStats = pDecodedModelCache->getStats();
+        stats.decodedModelHits = decodedStats.hits;
+        stats.decodedModelStores = decodedStats.stores;
+    }
+    if (pNegativeCachingAssetAccessor) {
+        auto negativeStats = pNegativeCachingAssetAccessor->getStats();
+        stats.negativeHits = negativeStats.hits;
+        stats.negativeEntries = negativeStats.entries;
+    }
+    return stats;
+}
+
+void CesiumTileset_setCacheLimits(uint64_t maxItems, uint64_t maxBytes, uint64_t memoryBytes) {
+    if (pMemoryCache) {
+        pMemoryCache->setMaxBytes(memoryBytes);
+    }
+    if (pSqliteCache) {
+        pSqliteCache->setLimits(maxItems, maxBytes);
+    }
+}
+
+void CesiumTileset_setCachePolicy(CesiumCachePolicy policy) {
+    if (pSqliteCache) {
+        pSqliteCache->setPolicy(toCachePrunePolicy(policy));
+    }
+}
+
+void CesiumTileset_pruneCache() {
+    if (pCacheDatabase) {
+        pCacheDatabase->prune();
+    }
+}
+
+void CesiumTileset_clearCache() {
+    if (pNegativeCachingAssetAccessor) {
+        pNegativeCachingAssetAccessor->clear();
+    }
+    if (!pCacheDatabase) {
+        return;
+    }
+    // clearing waits for a commit in progress and deletes every blob file, so it is kept off the calling thread
+    TaskPriorityScope scope(TaskPriority::Background);
+    ioAsyncSystem.runInWorkerThread([]() {
+        if (!pCacheDatabase->clearAll()) {
+            spdlog::default_logger()->error("Failed to clear the tile cache");
+        }
+    });
+}
+
+void CesiumTileset_setGlobalRateLimit(double bytesPerSecond, double requestsPerSecond) {
+    if (!pThrottlingAssetAccessor) {
+        return;
+    }
+    pThrottlingAssetAccessor->setGlobalLimits({ bytesPerSecond, requestsPerSecond });
+}
+
+void CesiumTileset_setHostRateLimit(const char* host, double bytesPerSecond, double requestsPerSecond) {
+    if (!pThrottlingAssetAccessor) {
+        return;
+    }
+    if (host) {
+        pThrottlingAssetAccessor->setHostLimits(host, { bytesPerSecond, requestsPerSecond });
+    } else {
+        pThrottlingAssetAccessor->setDefaultHostLimits({ bytesPerSecond, requestsPerSecond });
+    }
+}
+
+// Returns the accessor the tileset loads through: pRetryingAssetAccessor, behind the decoded model
+// cache if the tileset uses it. The model cache is also set as the tileset's renderer options so
+// that newly decoded models are stored.
+static std::shared_ptr<CesiumAsync::IAssetAccessor> enableDecodedModelCache(
+    const CesiumTilesetOptions& cesiumTilesetOptions,
+    const std::shared_ptr<RetryingAssetAccessor>& pRetryingAssetAccessor,
+    TilesetOptions& options) {
+    if (!cesiumTilesetOptions.cacheDecodedModels || !pDecodedModelCache) {
+        return pRetryingAssetAccessor;
+    }
+    options.rendererOptions = pDecodedModelCache;
+    return std::make_shared<DecodedModelAssetAccessor>(pRetryingAssetAccessor, pDecodedModelCache);
+}
+
+// The accessor given to a tileset: the chain below it runs on the I/O workers, and the responses
+// continue on the tileset's workers with the priority of the code that requested them.
+static std::shared_ptr<CesiumAsync::IAssetAccessor> createExternalsAssetAccessor(const std::shared_ptr<CesiumAsync::IAssetAccessor>& pTilesetAssetAccessor) {
+    return std::make_shared<PriorityAssetAccessor>(std::make_shared<IoPoolAssetAccessor>(pTilesetAssetAccessor, ioAsyncSystem));
+}
+
+static std::shared_ptr<RetryingAssetAccessor> createTilesetAssetAccessor(const CesiumTilesetOptions& cesiumTilesetOptions) {
+    RetryPolicy policy;
+    policy.maxRetries = cesiumTilesetOptions.maxRetries;
+    policy.baseDelay = std::chrono::milliseconds(cesiumTilesetOptions.retryBaseDelayMs);
+    policy.hedgePercentile = cesiumTilesetOptions.hedgePercentile;
+    return std::make_shared<RetryingAssetAccessor>(pAssetAccessor, pUncoalescedAssetAccessor, pDelayScheduler, policy);
+}
+
+CesiumTilesetRequestStats CesiumTileset_getRequestStats(CesiumTileset* tileset) {
+    CesiumTilesetRequestStats stats {};
+    if (!tileset->pAssetAccessor) {
+        return stats;
+    }
+    auto retryStats = tileset->pAssetAccessor->getStats();
+    stats.requests = retryStats.requests;
+    stats.retries = retryStats.retries;
+    stats.hedges = retryStats.hedges;
+    stats.hedgeWins = retryStats.hedgeWins;
+    stats.failures = retryStats.failures;
+    return stats;
 }
 
 CesiumTileset* CesiumTileset_create(const char* url, CesiumTilesetOptions cesiumTilesetOptions, void(*onRootTileAvailableEvent)()) {
 
+    auto pTilesetAssetAccessor = createTilesetAssetAccessor(cesiumTilesetOptions);
+    TilesetOptions options;
+    auto pRequestTracker = std::make_shared<TilesetRequestTracker>(enableDecodedModelCache(cesiumTilesetOptions, pTilesetAssetAccessor, options));
     Cesium3DTilesSelection::TilesetExternals externals {
-      pAssetAccessor,
+      createExternalsAssetAccessor(pRequestTracker),
       pResourcePreparer,
       asyncSystem,
       pMockedCreditSystem};
 
-    externals.pAssetAccessor = pAssetAccessor;
     externals.pPrepareRendererResources = pResourcePreparer;
     
     // TODO - pass these in as arguments
-    TilesetOptions options;
         options.enableLodTransitionPeriod = cesiumTilesetOptions.enableLodTransitionPeriod;
     
     options.forbidHoles = cesiumTilesetOptions.forbidHoles;
@@ -215,16 +558,23 @@ CesiumTileset* CesiumTileset_create(const char* url, CesiumTilesetOptions cesium
     options.loadingDescendantLimit = cesiumTilesetOptions.loadingDescendantLimit;
 
     auto pTileset = new CesiumTileset();
+    pTileset->cancelStaleTileLoads = cesiumTilesetOptions.cancelStaleTileLoads;
+    pTileset->pAssetAccessor = pTilesetAssetAccessor;
+    pTileset->pRequestTracker = pRequestTracker;
     options.loadErrorCallback = [=](const TilesetLoadFailureDetails& details) {
         pTileset->loadErrorMessage = details.message;
         spdlog::default_logger()->error(details.message);
         pTileset->loadError = true;
     };
-    pTileset->tileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
-        externals,
-        url,
-        options
-    );
+    {
+        // nothing can be shown until the tileset's root has loaded
+        TaskPriorityScope scope(TaskPriority::Urgent);
+        pTileset->tileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
+            externals,
+            url,
+            options
+        );
+    }
     
     pTileset->tileset->getRootTileAvailableEvent().thenInMainThread([=]() { 
         onRootTileAvailableEvent();
@@ -236,14 +586,16 @@ CesiumTileset* CesiumTileset_create(const char* url, CesiumTilesetOptions cesium
 
 CesiumTileset* CesiumTileset_createFromIonAsset(int64_t assetId,  const char* accessToken, CesiumTilesetOptions cesiumTilesetOptions, void(*onRootTileAvailableEvent)()) {
 
+    auto pTilesetAssetAccessor = createTilesetAssetAccessor(cesiumTilesetOptions);
+    TilesetOptions options;
+    auto pRequestTracker = std::make_shared<TilesetRequestTracker>(enableDecodedModelCache(cesiumTilesetOptions, pTilesetAssetAccessor, options));
     Cesium3DTilesSelection::TilesetExternals externals {
-      pAssetAccessor,
+      createExternalsAssetAccessor(pRequestTracker),
       pResourcePreparer,
       asyncSystem,
       pMockedCreditSystem};
 
     // TODO - pass these in as arguments
-    TilesetOptions options;
     
     // options.delayRefinementForOcclusion = true;
     options.enableLodTransitionPeriod = cesiumTilesetOptions.enableLodTransitionPeriod;
@@ -264,17 +616,24 @@ CesiumTileset* CesiumTileset_createFromIonAsset(int64_t assetId,  const char* ac
     
     
     auto pTileset = new CesiumTileset();
+    pTileset->cancelStaleTileLoads = cesiumTilesetOptions.cancelStaleTileLoads;
+    pTileset->pAssetAccessor = pTilesetAssetAccessor;
+    pTileset->pRequestTracker = pRequestTracker;
     options.loadErrorCallback = [=](const TilesetLoadFailureDetails& details) {
         pTileset->loadErrorMessage = details.message;
         spdlog::default_logger()->error(details.message);
         pTileset->loadError = true;
     };
-    pTileset->tileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
-        externals,
-        assetId,
-        accessToken,
-        options
-    );
+    {
+        // nothing can be shown until the tileset's root has loaded
+        TaskPriorityScope scope(TaskPriority::Urgent);
+        pTileset->tileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
+            externals,
+            assetId,
+            accessToken,
+            options
+        );
+    }
 
     pTileset->tileset->getRootTileAvailableEvent().thenInMainThread([=]() { 
         onRootTileAvailableEvent();
@@ -310,8 +669,159 @@ void CesiumTileset_destroy(CesiumTileset* tileset, void(*onTileDestroyEvent)())
     asyncSystem.dispatchMainThreadTasks();
     // Delete the CesiumTileset object
     delete tileset;
+    CesiumTileset_flushCache();
+}
+
+void CesiumTileset_flushCache() {
+    if (pSqliteCache) {
+        pSqliteCache->flush();
+    }
+}
+
+struct CesiumSeed {
+    std::unique_ptr<RegionSeeder> seeder;
+};
+
+static CesiumSeed* seedRegion(const CesiumSeedOptions& seedOptions, void(*callback)(CesiumSeedProgress), RegionSeeder::TilesetFactory createTileset) {
+    if (!pCacheDatabase) {
+        spdlog::default_logger()->error("Seeding a region requires a tile cache");
+        return nullptr;
+    }
+    if (seedOptions.north < seedOptions.south || seedOptions.minHeight > seedOptions.maxHeight) {
+        spdlog::default_logger()->error("Invalid seed region: north must not be below south, nor minHeight above maxHeight");
+        return nullptr;
+    }
+
+    SeedRegion region;
+    region.west = seedOptions.west;
+    region.south = seedOptions.south;
+    region.east = seedOptions.east;
+    region.north = seedOptions.north;
+    region.minHeight = seedOptions.minHeight;
+    region.maxHeight = seedOptions.maxHeight;
+    region.maximumScreenSpaceError = seedOptions.maximumScreenSpaceError;
+    region.viewpointsPerAxis = seedOptions.viewpointsPerAxis;
+
+    // The seeding tileset dispatches its own main thread tasks on the seeder thread, so it gets an
+    // AsyncSystem of its own (sharing the worker threads). Its requests are coalesced with those of
+    // application tilesets: below the I/O pool every future belongs to the I/O AsyncSystem, so a
+    // shared one never continues on another tileset's main thread.
+    Cesium3DTilesSelection::TilesetExternals externals {
+        createExternalsAssetAccessor(
+            std::make_shared<RetryingAssetAccessor>(pAssetAccessor, pUncoalescedAssetAccessor, pDelayScheduler, RetryPolicy())),
+        pResourcePreparer,
+        CesiumAsync::AsyncSystem { pTaskProcessor },
+        pMockedCreditSystem };
+
+    auto pSeed = new CesiumSeed();
+    pSeed->seeder = std::make_unique<RegionSeeder>(
+        region,
+        seedOptions.maxConcurrentRequests,
+        seedOptions.statePath ? seedOptions.statePath : "",
+        externals,
+        pSqliteCache,
+        std::move(createTileset),
+        [callback](const SeedProgress& progress) {
+            CesiumSeedProgress out {};
+            out.state = static_cast<CesiumSeedState>(progress.state);
+            out.completedViewpoints = progress.completedViewpoints;
+            out.totalViewpoints = progress.totalViewpoints;
+            out.requests = progress.requests;
+            out.bytes = progress.bytes;
+            callback(out);
+        });
+    return pSeed;
+}
+
+CesiumSeed* CesiumTileset_seedRegion(const char* url, CesiumSeedOptions options, void(*callback)(CesiumSeedProgress)) {
+    return seedRegion(options, callback, [url = std::string(url)](const TilesetExternals& externals, const TilesetOptions& tilesetOptions) {
+        return std::make_unique<Cesium3DTilesSelection::Tileset>(externals, url, tilesetOptions);
+    });
+}
+
+CesiumSeed* CesiumTileset_seedRegionFromIonAsset(int64_t assetId, const char* accessToken, CesiumSeedOptions options, void(*callback)(CesiumSeedProgress)) {
+    return seedRegion(options, callback, [assetId, accessToken = std::string(accessToken)](const TilesetExternals& externals, const TilesetOptions& tilesetOptions) {
+        return std::make_unique<Cesium3DTilesSelection::Tileset>(externals, assetId, accessToken, tilesetOptions);
+    });
 }
 
+void CesiumTileset_cancelSeed(CesiumSeed* seed) {
+    seed->seeder->cancel();
+}
+
+void CesiumTileset_destroySeed(CesiumSeed* seed) {
+    seed->seeder->cancel();
+    seed->seeder->stopReporting();
+    // the viewpoint being loaded still has to finish; wait for it on a thread of its own
+    seedTeardownThreads.start([pSeeder = std::shared_ptr<RegionSeeder>(std::move(seed->seeder))]() mutable {
+        pSeeder.reset();
+        CesiumTileset_flushCache();
+    });
+    delete seed;
+}
+
+
+// Number of consecutive frames a loading tile must stay culled or unvisited before its request is cancelled.
+// This keeps tiles at the edge of the view from being cancelled and re-requested every frame.
+static const int kStaleTileLoadFrames = 10;
+
+// Cancels the downloads of tiles that are still loading but have been culled or left unvisited for
+// kStaleTileLoadFrames frames. Only tiles with an explicit content URL can be matched to a request;
+// implicit (quadtree/octree) tiles are left alone. Content URLs are resolved to the exact URLs this
+// tileset requested, so the loads of other tilesets are never touched, and a download shared with
+// another waiter through request coalescing is kept. Cancelled tiles fail temporarily and are
+// requested again if they come back into view.
+static void cancelStaleTileLoads(CesiumTileset* tileset) {
+    const Tile* root = tileset->tileset->getRootTile();
+    if (!root || (!pCurlAssetAccessor && !pThrottlingAssetAccessor) || !tileset->pRequestTracker) {
+        return;
+    }
+
+    int frameNumber = tileset->lastUpdateResult.frameNumber;
+    std::unordered_map<const Tile*, int> staleLoadingTiles;
+    std::vector<std::string> staleContentUris;
+
+    std::function<void(const Tile&)> visit = [&](const Tile& tile) {
+        if (tile.getState() == TileLoadState::ContentLoading) {
+            auto result = tile.getLastSelectionState().getResult(frameNumber);
+            const std::string* url = std::get_if<std::string>(&tile.getTileID());
+            if (url && (result == TileSelectionState::Result::None || result == TileSelectionState::Result::Culled)) {
+                auto it = tileset->staleLoadingTiles.find(&tile);
+                int staleSince = it == tileset->staleLoadingTiles.end() ? frameNumber : it->second;
+                if (frameNumber - staleSince >= kStaleTileLoadFrames) {
+                    staleContentUris.push_back(*url);
+                } else {
+                    staleLoadingTiles.emplace(&tile, staleSince);
+                }
+            }
+        }
+        for (const Tile& child : tile.getChildren()) {
+            visit(child);
+        }
+    };
+    visit(*root);
+    tileset->staleLoadingTiles = std::move(staleLoadingTiles);
+
+    if (staleContentUris.empty()) {
+        return;
+    }
+    auto staleUrls = tileset->pRequestTracker->findInFlightUrls(staleContentUris);
+    if (staleUrls.empty()) {
+        return;
+    }
+
+    auto isStale = [staleUrls = std::set<std::string>(staleUrls.begin(), staleUrls.end())](const std::string& url) {
+        // checked right before the request is cancelled
+        return staleUrls.count(url) && (!pCoalescingAssetAccessor || pCoalescingAssetAccessor->getWaiterCount(url) <= 1);
+    };
+    // requests still waiting in the rate limiter never reach libcurl
+    if (pThrottlingAssetAccessor) {
+        pThrottlingAssetAccessor->cancelRequests(isStale);
+    }
+    if (pCurlAssetAccessor) {
+        pCurlAssetAccessor->cancelRequests(isStale);
+    }
+}
 
 int CesiumTileset_updateView(CesiumTileset* tileset, const CesiumViewState viewState, float deltaTime) {
     if (!tileset) return -1;
@@ -329,6 +839,10 @@ int CesiumTileset_updateView(CesiumTileset* tileset, const CesiumViewState viewS
     );
 
     tileset->lastUpdateResult = tileset->tileset->updateView({cesiumViewState}, deltaTime);    
+
+    if (tileset->cancelStaleTileLoads) {
+        cancelStaleTileLoads(tileset);
+    }
   
     return static_cast<int>(tileset->lastUpdateResult.tilesToRenderThisFrame.size());
 }
@@ -818,6 +1332,8 @@ uint8_t* CesiumGltfModel_serialize_to_data_uri(CesiumGltfModel* opaqueModel, uin
 }
 
 void CesiumGltfModel_serializeAsync(CesiumGltfModel* opaqueModel, void(*callback)(SerializedCesiumGltfModel)) {
+    // a burst of serializations must not delay the loads of visible tiles
+    TaskPriorityScope scope(TaskPriority::Background);
     auto fut = asyncSystem.runInWorkerThread([=]() { 
         auto serialized = CesiumGltfModel_serialize(opaqueModel);
         callback(serialized);
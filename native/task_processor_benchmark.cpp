@@ -0,0 +1,188 @@
+// Compares the contention of SimpleTaskProcessor and WorkStealingTaskProcessor.
+//
+// Build (from native/):
+//   g++ -std=c++17 -O2 -Iinclude -Ithirdparty/include task_processor_benchmark.cpp -o task_processor_benchmark -lpthread
+// Run:
+//   ./task_processor_benchmark [threads] [tasks]
+//
+// Each scenario is timed until all of its tasks have run. Start latency is the time from
+// startTask() until the task begins executing.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SimpleTaskProcessor.hpp"
+#include "WorkStealingTaskProcessor.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double seconds = 0;
+    double meanStartLatencyUs = 0;
+    double maxStartLatencyUs = 0;
+};
+
+class Counter {
+public:
+    explicit Counter(uint64_t target) : _target(target) {}
+
+    void recordStart(Clock::time_point submitted) {
+        auto latency = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - submitted).count());
+        _latencySum.fetch_add(latency, std::memory_order_relaxed);
+        uint64_t max = _latencyMax.load(std::memory_order_relaxed);
+        while (latency > max && !_latencyMax.compare_exchange_weak(max, latency, std::memory_order_relaxed)) {
+        }
+    }
+
+    void done() {
+        _done.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    void wait() const {
+        while (_done.load(std::memory_order_acquire) < _target) {
+            std::this_thread::yield();
+        }
+    }
+
+    Result result(Clock::time_point start) const {
+        Result result;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.meanStartLatencyUs = _latencySum.load() / 1000.0 / static_cast<double>(_target);
+        result.maxStartLatencyUs = _latencyMax.load() / 1000.0;
+        return result;
+    }
+
+private:
+    uint64_t _target;
+    std::atomic<uint64_t> _done { 0 };
+    std::atomic<uint64_t> _latencySum { 0 };
+    std::atomic<uint64_t> _latencyMax { 0 };
+};
+
+// Roughly the cost of a small continuation (a few hundred ns).
+static void work(uint32_t iterations) {
+    volatile uint32_t value = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        value = value * 31 + i;
+    }
+}
+
+static void submit(CesiumAsync::ITaskProcessor& processor, Counter& counter, uint32_t iterations) {
+    auto submitted = Clock::now();
+    processor.startTask([&counter, submitted, iterations]() {
+        counter.recordStart(submitted);
+        work(iterations);
+        counter.done();
+    });
+}
+
+// Every task is started from a thread outside the pool, like tile requests started by the main
+// thread and completions delivered by the network thread.
+static Result externalSubmitters(CesiumAsync::ITaskProcessor& processor, size_t submitters, uint64_t tasks) {
+    Counter counter(tasks);
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t s = 0; s < submitters; s++) {
+        threads.emplace_back([&, s]() {
+            for (uint64_t i = s; i < tasks; i += submitters) {
+                submit(processor, counter, 200);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    counter.wait();
+    return counter.result(start);
+}
+
+// Each task starts continuations from inside the pool, like a tile load chaining decode,
+// upsampling and renderer preparation.
+static Result fanOut(CesiumAsync::ITaskProcessor& processor, uint64_t tasks) {
+    const uint64_t kRoots = 64;
+    const uint64_t perRoot = tasks / kRoots;
+    Counter counter(kRoots * perRoot);
+    auto start = Clock::now();
+    std::function<void(uint64_t, Clock::time_point)> step = [&](uint64_t remaining, Clock::time_point submitted) {
+        counter.recordStart(submitted);
+        work(200);
+        if (remaining > 1) {
+            // two children, so the pool has to steal to stay busy
+            uint64_t left = remaining / 2;
+            uint64_t right = remaining - 1 - left;
+            for (uint64_t child : { left, right }) {
+                if (child > 0) {
+                    auto now = Clock::now();
+                    processor.startTask([&step, child, now]() { step(child, now); });
+                }
+            }
+        }
+        counter.done();
+    };
+    for (uint64_t r = 0; r < kRoots; r++) {
+        auto now = Clock::now();
+        processor.startTask([&step, perRoot, now]() { step(perRoot, now); });
+    }
+    counter.wait();
+    return counter.result(start);
+}
+
+// Short bursts with idle gaps in between, so workers go to sleep and have to be woken.
+static Result bursts(CesiumAsync::ITaskProcessor& processor, uint64_t tasks) {
+    const uint64_t kBurst = 32;
+    Counter counter(tasks);
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < tasks; i += kBurst) {
+        for (uint64_t j = i; j < std::min(tasks, i + kBurst); j++) {
+            submit(processor, counter, 2000);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    counter.wait();
+    auto result = counter.result(start);
+    return result;
+}
+
+template <typename Processor>
+static void runAll(const char* name, size_t threads, uint64_t tasks) {
+    auto report = [name](const char* scenario, const Result& result, uint64_t count) {
+        std::printf("%-14s %-22s %8.1f ms %10.0f tasks/s  start latency mean %8.1f us  max %9.1f us\n",
+            name, scenario, result.seconds * 1000.0, static_cast<double>(count) / result.seconds,
+            result.meanStartLatencyUs, result.maxStartLatencyUs);
+    };
+    {
+        Processor processor(threads);
+        report("1 submitter", externalSubmitters(processor, 1, tasks), tasks);
+    }
+    {
+        Processor processor(threads);
+        report("4 submitters", externalSubmitters(processor, 4, tasks), tasks);
+    }
+    {
+        Processor processor(threads);
+        report("fan-out in pool", fanOut(processor, tasks), tasks / 64 * 64);
+    }
+    {
+        Processor processor(threads);
+        uint64_t burstTasks = std::min<uint64_t>(tasks, 20000);
+        report("bursts with idle gaps", bursts(processor, burstTasks), burstTasks);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t threads = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+    uint64_t tasks = argc > 2 ? static_cast<uint64_t>(std::atoll(argv[2])) : 500000;
+    std::printf("%zu worker threads, %llu tasks per scenario\n", threads, static_cast<unsigned long long>(tasks));
+    runAll<SimpleTaskProcessor>("simple", threads, tasks);
+    runAll<WorkStealingTaskProcessor>("work-stealing", threads, tasks);
+    return 0;
+}